@@ -0,0 +1,115 @@
+//
+// Created by icarr on 17/10/2026.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <glad/gl.h>
+
+#include <gldraw/dirty_range.h>
+
+namespace gldraw {
+    /// binding of the texture handle table read by the bindless coloured_vertex shaders
+    constexpr GLuint TEXTURE_HANDLE_BINDING = 1;
+
+    /// Resident GL_ARB_bindless_texture handles in a shader storage buffer. Shaders pick a texture by its
+    /// index in the table, so draws using different textures need no bind between them and can share a
+    /// batch. Check is_supported() first and keep binding textures where it is false.
+    class BindlessTextures {
+    public:
+        BindlessTextures() {
+            glCreateBuffers(1, &_buffer);
+        }
+
+        ~BindlessTextures() {
+            for (GLuint64 handle: _handles) {
+                if (handle != 0) {
+                    glMakeTextureHandleNonResidentARB(handle);
+                }
+            }
+            glDeleteBuffers(1, &_buffer);
+        }
+
+        BindlessTextures(const BindlessTextures &other) = delete;
+        BindlessTextures &operator=(const BindlessTextures &other) = delete;
+
+    public:
+        /// true when the driver exposes GL_ARB_bindless_texture
+        static bool is_supported() {
+            return GLAD_GL_ARB_bindless_texture != 0;
+        }
+
+        /// The table index of texture, making it resident the first time it is seen. Taking the handle
+        /// freezes the texture's sampler state, set its parameters and storage first.
+        uint32_t add(GLuint texture) {
+            auto found = _indices.find(texture);
+            if (found != _indices.end()) {
+                return found->second;
+            }
+
+            const GLuint64 handle = glGetTextureHandleARB(texture);
+            glMakeTextureHandleResidentARB(handle);
+
+            uint32_t indx;
+            if (_free_indices.empty()) {
+                indx = _handles.size();
+                _handles.push_back(handle);
+            } else {
+                indx = _free_indices.back();
+                _free_indices.pop_back();
+                _handles[indx] = handle;
+            }
+            _indices.emplace(texture, indx);
+            _dirty.add(indx, indx + 1);
+            return indx;
+        }
+
+        /// make texture non resident before it is deleted, its index is reused
+        void remove(GLuint texture) {
+            auto found = _indices.find(texture);
+            if (found == _indices.end()) {
+                return;
+            }
+
+            const uint32_t indx = found->second;
+            glMakeTextureHandleNonResidentARB(_handles[indx]);
+            _handles[indx] = 0;
+            _dirty.add(indx, indx + 1);
+            _free_indices.push_back(indx);
+            _indices.erase(found);
+        }
+
+        /// upload handles added since the last call and bind the table at TEXTURE_HANDLE_BINDING
+        void bind() {
+            if (_handles.size() > _buf_size) {
+                // the table only grows, reallocate with room for more
+                _buf_size = std::max<size_t>(2 * _handles.size(), 16);
+                glNamedBufferData(_buffer, _buf_size * sizeof(GLuint64), nullptr, GL_DYNAMIC_DRAW);
+                _dirty.clear();
+                _dirty.add(0, _handles.size());
+            }
+            for (const element_range &range: _dirty.ranges()) {
+                glNamedBufferSubData(_buffer, range.begin * sizeof(GLuint64), range.size() * sizeof(GLuint64), _handles.data() + range.begin);
+            }
+            _dirty.clear();
+
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, TEXTURE_HANDLE_BINDING, _buffer);
+        }
+
+        [[nodiscard]] size_t get_resident_count() const { return _indices.size(); }
+
+    private:
+        GLuint _buffer{};
+        size_t _buf_size{};
+
+        std::vector<GLuint64> _handles;
+        std::vector<uint32_t> _free_indices;
+        std::unordered_map<GLuint, uint32_t> _indices;
+        dirty_ranges _dirty;
+    };
+}
@@ -0,0 +1,168 @@
+//
+// Created by icarr on 17/10/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <glad/gl.h>
+
+namespace gldraw {
+    constexpr uint64_t FNV1A_OFFSET = 0xcbf29ce484222325ull;
+    constexpr uint64_t FNV1A_PRIME = 0x100000001b3ull;
+
+    /// 64 bit FNV-1a, pass a previous result as seed to hash discontiguous data as one range
+    inline uint64_t hash_bytes(const void *data, size_t size, uint64_t seed = FNV1A_OFFSET) {
+        const auto *bytes = static_cast<const uint8_t *>(data);
+        uint64_t hash = seed;
+        for (size_t indx = 0; indx < size; ++indx) {
+            hash = (hash ^ bytes[indx]) * FNV1A_PRIME;
+        }
+        return hash;
+    }
+
+    /// Checks GPU buffers hold what the CPU uploaded without stalling the pipeline. A sampled buffer
+    /// range is copied into a readback buffer with glCopyBufferSubData and fenced, poll() hashes the
+    /// copy once its fence has signalled, some frames later, and compares it with the CPU hash.
+    class BufferValidator {
+    public:
+        /// @param sample_interval validate one in sample_interval requests, 0 disables validation
+        /// @param max_in_flight requests arriving while this many checks are pending are dropped
+        explicit BufferValidator(unsigned int sample_interval = 30, unsigned int max_in_flight = 8) :
+                _sample_interval(sample_interval), _max_in_flight(max_in_flight) {}
+
+        ~BufferValidator() {
+            for (pending_check &check: _pending) {
+                glDeleteSync(check.fence);
+                _free_readbacks.push_back(check.readback);
+            }
+            for (readback_buffer &readback: _free_readbacks) {
+                glDeleteBuffers(1, &readback.buffer);
+            }
+        }
+
+        BufferValidator(const BufferValidator &other) = delete;
+        BufferValidator &operator=(const BufferValidator &other) = delete;
+
+    public:
+        void set_sample_interval(unsigned int sample_interval) { _sample_interval = sample_interval; }
+        [[nodiscard]] unsigned int get_sample_interval() const { return _sample_interval; }
+
+        /// counts a validation request, true when it has been selected for checking
+        /// callers skip hashing entirely when this is false
+        bool sample() {
+            if (_sample_interval == 0 || _pending.size() >= _max_in_flight) {
+                return false;
+            }
+            return _request_count++ % _sample_interval == 0;
+        }
+
+        /// queue a check that size bytes of buffer from offset hash to expected_hash
+        void submit(GLuint buffer, size_t offset, size_t size, uint64_t expected_hash, std::string label) {
+            if (size == 0) {
+                return;
+            }
+
+            readback_buffer readback = acquire_readback(size);
+
+            glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, readback.buffer);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, offset, 0, size);
+            glBindBuffer(GL_COPY_READ_BUFFER, 0);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+            _pending.push_back({readback, size, expected_hash, std::move(label),
+                                glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0)});
+        }
+
+        /// check every request whose copy has completed, never waits
+        /// @param on_failure called with the label of each range whose hash did not match
+        /// @return the number of failed checks
+        template<typename TCallback>
+        unsigned int poll(TCallback &&on_failure) {
+            unsigned int failures = 0;
+
+            // fences signal in submission order, stop at the first still in flight
+            while (!_pending.empty()) {
+                pending_check &check = _pending.front();
+                GLenum status = glClientWaitSync(check.fence, 0, 0);
+                if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+                    break;
+                }
+                glDeleteSync(check.fence);
+
+                glBindBuffer(GL_COPY_READ_BUFFER, check.readback.buffer);
+                const void *p_data = glMapBufferRange(GL_COPY_READ_BUFFER, 0, check.size, GL_MAP_READ_BIT);
+                if (p_data != nullptr) {
+                    if (hash_bytes(p_data, check.size) != check.expected_hash) {
+                        ++failures;
+                        on_failure(check.label);
+                    }
+                    glUnmapBuffer(GL_COPY_READ_BUFFER);
+                }
+                glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+                _free_readbacks.push_back(check.readback);
+                _pending.pop_front();
+            }
+
+            return failures;
+        }
+
+    private:
+        struct readback_buffer {
+            GLuint buffer{};
+            size_t capacity{};
+        };
+
+        struct pending_check {
+            readback_buffer readback;
+            size_t size{};
+            uint64_t expected_hash{};
+            std::string label;
+            GLsync fence{};
+        };
+
+        /// a free readback buffer of at least size bytes, the largest free one is grown if none fit
+        readback_buffer acquire_readback(size_t size) {
+            auto best = _free_readbacks.end();
+            for (auto it = _free_readbacks.begin(); it != _free_readbacks.end(); ++it) {
+                if (best == _free_readbacks.end() || it->capacity > best->capacity) {
+                    best = it;
+                }
+                if (it->capacity >= size) {
+                    best = it;
+                    break;
+                }
+            }
+
+            readback_buffer readback;
+            if (best != _free_readbacks.end()) {
+                readback = *best;
+                _free_readbacks.erase(best);
+            } else {
+                glGenBuffers(1, &readback.buffer);
+            }
+
+            if (readback.capacity < size) {
+                glBindBuffer(GL_COPY_WRITE_BUFFER, readback.buffer);
+                glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_STREAM_READ);
+                glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+                readback.capacity = size;
+            }
+            return readback;
+        }
+
+    private:
+        unsigned int _sample_interval;
+        unsigned int _max_in_flight;
+        uint64_t _request_count{};
+
+        std::deque<pending_check> _pending;
+        std::vector<readback_buffer> _free_readbacks;
+    };
+}
@@ -0,0 +1,228 @@
+//
+// Created by icarr on 17/10/2026.
+//
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+#include <glad/gl.h>
+
+#include <gldraw/VertexManager.h>
+#include <gldraw/frame_arena.h>
+#include <gldraw/quad_indices.h>
+#include <gldraw/vertex_layout.h>
+#include <gldraw/shaders/coloured_vertex.h>
+#include <glmath/matrices.h>
+
+namespace gldraw {
+    /// layout of a GL_DRAW_INDIRECT_BUFFER entry for glMultiDrawElementsIndirect
+    struct draw_elements_indirect_command {
+        GLuint count{};
+        GLuint instance_count{};
+        GLuint first_index{};
+        GLint base_vertex{};
+        GLuint base_instance{};
+    };
+    static_assert(sizeof(draw_elements_indirect_command) == 5 * sizeof(GLuint));
+
+    /// Collects the staged geometry of many VertexManagers sharing a vertex format into one vertex
+    /// and index arena and submits it with a single glMultiDrawElementsIndirect. Each draw reads its
+    /// model matrix through gl_DrawID, see get_batched_coloured_vertex_shader, and with
+    /// get_batched_bindless_coloured_vertex_shader its texture too.
+    template<vertex_layout TVertex>
+    class DrawBatch {
+    public:
+        using vertex_type = TVertex;
+    public:
+        DrawBatch() {
+            glCreateVertexArrays(1, &_VAO);
+            glCreateBuffers(1, &_VBO);
+            glCreateBuffers(1, &_EBO);
+            glGenBuffers(1, &_indirect_buffer);
+            glGenBuffers(1, &_model_buffer);
+            glGenBuffers(1, &_draw_texture_buffer);
+
+            configure_vertex_array<TVertex>(_VAO);
+            bind_vertex_buffer<TVertex>(_VAO, _VBO);
+        }
+
+        /// stage the arena contents in a frame_arena, clear() must be called after each arena reset
+        explicit DrawBatch(frame_arena &arena) :
+                DrawBatch() {
+            _arena = &arena;
+            _arena_generation = arena.generation();
+            std::destroy_at(&_vertices);
+            std::construct_at(&_vertices, &arena);
+            std::destroy_at(&_indices);
+            std::construct_at(&_indices, &arena);
+        }
+
+        ~DrawBatch() {
+            glDeleteVertexArrays(1, &_VAO);
+            glDeleteBuffers(1, &_VBO);
+            glDeleteBuffers(1, &_EBO);
+            glDeleteBuffers(1, &_indirect_buffer);
+            glDeleteBuffers(1, &_model_buffer);
+            glDeleteBuffers(1, &_draw_texture_buffer);
+        }
+
+        DrawBatch(const DrawBatch &other) = delete;
+        DrawBatch &operator=(const DrawBatch &other) = delete;
+
+    public:
+        [[nodiscard]] unsigned int get_draw_count() const {
+            return _commands.size();
+        }
+
+        void clear() {
+            _vertices.clear();
+            _indices.clear();
+            if (_arena != nullptr && _arena_generation != _arena->generation()) {
+                // the arena was reset, drop the storage without touching it
+                std::pmr::vector<vertex_type>(_arena).swap(_vertices);
+                std::pmr::vector<unsigned int>(_arena).swap(_indices);
+                _arena_generation = _arena->generation();
+            }
+            _commands.clear();
+            _models.clear();
+            _draw_textures.clear();
+        }
+
+        /// append the staged geometry of manager as one draw of the batch
+        /// @param texture_index the draw's entry in the BindlessTextures table, unused by the bound texture shaders
+        void add(const VertexManager<vertex_type> &manager, const glmath::mat4x4 &model = glmath::mat4x4::identity,
+                 uint32_t texture_index = 0) {
+            // persistent_ring managers keep no CPU copy of their geometry
+            assert(manager.get_usage() != buffer_usage::persistent_ring);
+            assert(_arena == nullptr || _arena_generation == _arena->generation());
+
+            std::span<const vertex_type> vertices = manager.get_vertices();
+            if (vertices.empty()) {
+                return;
+            }
+
+            draw_elements_indirect_command command;
+            command.count = manager.get_element_count();
+            command.instance_count = 1;
+            command.first_index = _indices.size();
+            // manager indices start at zero, the base vertex moves them into the arena
+            command.base_vertex = static_cast<GLint>(_vertices.size());
+            command.base_instance = _commands.size();
+
+            _vertices.insert(_vertices.end(), vertices.begin(), vertices.end());
+
+            if (manager.is_quads_only()) {
+                size_t first_indx = _indices.size();
+                _indices.resize(first_indx + command.count);
+                for (size_t quad = 0; quad < vertices.size() / 4; ++quad) {
+                    write_quad_indices(_indices.data() + first_indx + 6 * quad, static_cast<unsigned int>(4 * quad));
+                }
+            } else {
+                std::span<const unsigned int> indices = manager.get_indices();
+                _indices.insert(_indices.end(), indices.begin(), indices.end());
+            }
+
+            _commands.push_back(command);
+            _models.push_back(model);
+            _draw_textures.push_back(texture_index);
+        }
+
+        /// replace the model matrix of a draw without rebuilding the arena
+        void set_model(unsigned int draw, const glmath::mat4x4 &model) {
+            assert(draw < _models.size());
+            _models[draw] = model;
+        }
+
+    public:
+        void gen_buffers() {
+            glBindVertexArray(_VAO);
+
+            glBindBuffer(GL_ARRAY_BUFFER, _VBO);
+            upload(GL_ARRAY_BUFFER, _vertices, _vert_buf_size, 1);
+#if defined ZINK_BUFFER_CORRUPTION_BUG
+            // keep the default vertex past the end of the arena as VertexManager does
+            const vertex_type padding{};
+            glBufferSubData(GL_ARRAY_BUFFER, _vertices.size() * sizeof(vertex_type), sizeof(vertex_type), &padding);
+#endif
+
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _EBO);
+            upload(GL_ELEMENT_ARRAY_BUFFER, _indices, _ind_buf_size);
+
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _indirect_buffer);
+            upload(GL_DRAW_INDIRECT_BUFFER, _commands, _cmd_buf_size);
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, _draw_texture_buffer);
+            upload(GL_SHADER_STORAGE_BUFFER, _draw_textures, _draw_texture_buf_size);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+            upload_models();
+        }
+
+        /// upload just the model matrices, for batches where only the transforms move
+        void upload_models() {
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, _model_buffer);
+            upload(GL_SHADER_STORAGE_BUFFER, _models, _model_buf_size);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        }
+
+        /// draw every entry of the batch, the VAO is left bound
+        void draw() {
+            if (_commands.empty()) {
+                return;
+            }
+
+            glBindVertexArray(_VAO);
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, MODEL_MATRIX_BINDING, _model_buffer);
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, DRAW_TEXTURE_BINDING, _draw_texture_buffer);
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, _indirect_buffer);
+
+            glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, _commands.size(), 0);
+
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        }
+
+        [[nodiscard]] unsigned int get_vao() const { return _VAO; }
+
+    private:
+        /// upload elements to the buffer bound to target, reusing it while it is large enough
+        /// @param padding extra elements allocated past the data
+        template<typename TElement, typename TAllocator>
+        static void upload(GLenum target, const std::vector<TElement, TAllocator> &elements, size_t &buf_size, size_t padding = 0) {
+            if (elements.size() <= buf_size && buf_size != 0) {
+                glBufferSubData(target, 0, elements.size() * sizeof(TElement), elements.data());
+                return;
+            }
+
+            glBufferData(target, (elements.size() + padding) * sizeof(TElement), nullptr, GL_STREAM_DRAW);
+            glBufferSubData(target, 0, elements.size() * sizeof(TElement), elements.data());
+            buf_size = elements.size();
+        }
+
+    private:
+        unsigned int _VBO{}, _VAO{}, _EBO{};
+        GLuint _indirect_buffer{};
+        GLuint _model_buffer{};
+        GLuint _draw_texture_buffer{};
+
+        std::pmr::vector<vertex_type> _vertices;
+        std::pmr::vector<unsigned int> _indices;
+        std::vector<draw_elements_indirect_command> _commands;
+        std::vector<glmath::mat4x4> _models;
+        std::vector<uint32_t> _draw_textures;
+
+        size_t _vert_buf_size{};
+        size_t _ind_buf_size{};
+        size_t _cmd_buf_size{};
+        size_t _model_buf_size{};
+        size_t _draw_texture_buf_size{};
+
+        frame_arena *_arena{};
+        uint64_t _arena_generation{};
+    };
+}
@@ -0,0 +1,86 @@
+//
+// Created by icarr on 17/10/2026.
+//
+
+#pragma once
+
+#include <cassert>
+#include <exception>
+#include <format>
+#include <future>
+#include <memory>
+#include <utility>
+
+#include <XPLMUtilities.h>
+
+#include <gldraw/VertexManager.h>
+#include <gldraw/vertex_layout.h>
+#include <gldraw/worker_pool.h>
+
+namespace gldraw {
+    /// Double buffered geometry for one display. The geometry for the next frame is built on a worker
+    /// pool into the back VertexManager's staging while the front one is drawn, the GL thread only
+    /// uploads and draws. The builder runs on a worker so it may only clear() and add geometry, and
+    /// must capture a copy of any sim state it needs.
+    template<vertex_layout TVertex>
+    class GeometryPipeline {
+    public:
+        using manager_type = VertexManager<TVertex>;
+    public:
+        /// @param usage persistent_ring is not supported, its clear() waits on GL fences
+        explicit GeometryPipeline(worker_pool &pool, buffer_usage usage = buffer_usage::stream) :
+                _pool(pool),
+                _front(std::make_unique<manager_type>(usage)),
+                _back(std::make_unique<manager_type>(usage)) {
+            assert(usage != buffer_usage::persistent_ring);
+        }
+
+        ~GeometryPipeline() {
+            // the worker may still be writing to the back manager
+            if (_pending.valid()) {
+                _pending.wait();
+            }
+        }
+
+        GeometryPipeline(const GeometryPipeline &other) = delete;
+        GeometryPipeline &operator=(const GeometryPipeline &other) = delete;
+
+    public:
+        /// GL thread: collect the geometry started during the previous frame, upload it and start
+        /// building the following frame with builder(manager_type &). The very first frame is built
+        /// here. A builder that throws is logged and the previous frame's geometry is drawn again, this
+        /// runs in X-Plane's draw callbacks which exceptions must not escape.
+        /// @return the manager to draw this frame
+        template<typename TBuilder>
+        manager_type &next_frame(TBuilder builder) {
+            try {
+                if (_pending.valid()) {
+                    _pending.get();
+                    std::swap(_front, _back);
+                } else {
+                    builder(*_front);
+                }
+            } catch (const std::exception &ex) {
+                XPLMDebugString(std::format("geometry build failed, redrawing the previous frame: {}\n", ex.what()).c_str());
+            }
+
+            _front->gen_buffers();
+
+            // nothing else touches the back manager until the next call
+            _pending = _pool.submit([builder = std::move(builder), back = _back.get()]() mutable {
+                builder(*back);
+            });
+
+            return *_front;
+        }
+
+        /// the manager drawn by the last next_frame
+        [[nodiscard]] manager_type &front() { return *_front; }
+
+    private:
+        worker_pool &_pool;
+        std::unique_ptr<manager_type> _front;
+        std::unique_ptr<manager_type> _back;
+        std::future<void> _pending;
+    };
+}
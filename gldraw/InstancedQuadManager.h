@@ -0,0 +1,106 @@
+//
+// Created by icarr on 17/10/2026.
+//
+
+#pragma once
+
+#include <cassert>
+#include <span>
+#include <vector>
+
+#include <glad/gl.h>
+
+#include <gldraw/geom.h>
+#include <gldraw/colour.h>
+#include <gldraw/vertex_layout.h>
+#include <gldraw/shaders/instanced_quad.h>
+
+namespace gldraw {
+    /// quads stored as one quad_instance each and drawn with a single glDrawArraysInstanced,
+    /// use with get_instanced_quad_shader
+    class InstancedQuadManager {
+    public:
+        InstancedQuadManager() {
+            // created rather than generated so the DSA calls below have objects to work on
+            glCreateVertexArrays(1, &_VAO);
+            glCreateBuffers(1, &_VBO);
+
+            // the attribute formats never change, reallocating the buffer keeps its name attached
+            configure_instance_array<quad_instance>(_VAO);
+            bind_vertex_buffer<quad_instance>(_VAO, _VBO);
+        }
+
+        ~InstancedQuadManager() {
+            glDeleteVertexArrays(1, &_VAO);
+            glDeleteBuffers(1, &_VBO);
+        }
+
+        InstancedQuadManager(const InstancedQuadManager &other) = delete;
+        InstancedQuadManager &operator=(const InstancedQuadManager &other) = delete;
+
+    public:
+        [[nodiscard]] unsigned int get_instance_count() const {
+            return _instances.size();
+        }
+
+    public:
+        void clear() {
+            _instances.clear();
+        }
+
+        /// @return the index of the new instance for update_quad
+        size_t add_quad(const gldraw::rect &rct, const gldraw::colour &colour = gldraw::COL_WHITE,
+                        const gldraw::rect &uv = gldraw::UV_UNIT, float rotation = 0.0f) {
+            _instances.emplace_back(rct, uv, colour, rotation);
+            return _instances.size() - 1;
+        }
+
+        /// append a quad per rect
+        /// @param colours empty for white or one per rect
+        /// @param uvs empty for the full 0..1 texture or one uv rect per rect
+        void add_quads(std::span<const gldraw::rect> rects, std::span<const gldraw::colour> colours = {},
+                       std::span<const gldraw::rect> uvs = {}) {
+            assert(colours.empty() || colours.size() == rects.size());
+            assert(uvs.empty() || uvs.size() == rects.size());
+
+            _instances.reserve(_instances.size() + rects.size());
+            for (size_t quad = 0; quad < rects.size(); ++quad) {
+                _instances.emplace_back(rects[quad], uvs.empty() ? gldraw::UV_UNIT : uvs[quad],
+                                        colours.empty() ? gldraw::COL_WHITE : colours[quad]);
+            }
+        }
+
+        void update_quad(size_t index, const quad_instance &instance) {
+            assert(index < _instances.size());
+            _instances[index] = instance;
+        }
+
+    public:
+        void gen_buffers() {
+            size_t inst_buf_size = _instances.size() * sizeof(quad_instance);
+
+            // do we re-use the buffer or generate a new larger one?
+            if (_instances.size() <= _inst_buf_size && _inst_buf_size != 0) {
+                glNamedBufferSubData(_VBO, 0, inst_buf_size, _instances.data());
+            } else {
+                glNamedBufferData(_VBO, inst_buf_size, _instances.data(), GL_STREAM_DRAW);
+                _inst_buf_size = _instances.size();
+            }
+        }
+
+        /// draw the current content, the VAO is left bound
+        void draw() {
+            glBindVertexArray(_VAO);
+            glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, get_instance_count());
+        }
+
+        [[nodiscard]] unsigned int get_vbo() const { return _VBO; }
+        [[nodiscard]] unsigned int get_vao() const { return _VAO; }
+
+    private:
+        unsigned int _VBO{}, _VAO{};
+        std::vector<quad_instance> _instances;
+
+        size_t _inst_buf_size{};
+    };
+}
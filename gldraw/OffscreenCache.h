@@ -0,0 +1,182 @@
+//
+// Created by icarr on 17/10/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <format>
+#include <vector>
+
+#include <glad/gl.h>
+
+#include <XPLMUtilities.h>
+
+namespace gldraw {
+    /// Offscreen colour targets keyed by content and size, so displays showing the same thing render it
+    /// once per sim frame and composite the texture. Content is rendered with premultiplied alpha, draw
+    /// the texture with glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA).
+    class OffscreenCache {
+    public:
+        /// @param max_idle_cycles entries not used for this many sim frames are released
+        explicit OffscreenCache(int max_idle_cycles = 120) : _max_idle_cycles(max_idle_cycles) {}
+
+        ~OffscreenCache() {
+            for (entry &ent: _entries) {
+                release(ent);
+            }
+        }
+
+        OffscreenCache(const OffscreenCache &other) = delete;
+        OffscreenCache &operator=(const OffscreenCache &other) = delete;
+
+    public:
+        /// the texture last rendered for content at width x height, 0 if there is none
+        /// @param rendered_cycle set to the sim frame it was rendered in when not null
+        GLuint find(uint64_t content, int width, int height, int cycle, int *rendered_cycle = nullptr) {
+            entry *ent = find_entry(content, width, height);
+            if (ent == nullptr || ent->rendered_cycle < 0) {
+                return 0;
+            }
+            ent->used_cycle = cycle;
+            if (rendered_cycle != nullptr) {
+                *rendered_cycle = ent->rendered_cycle;
+            }
+            return ent->texture;
+        }
+
+        /// Render content at width x height through render() unless that was already done this sim
+        /// frame. render() draws into a cleared target whose viewport is 0, 0, width, height, the
+        /// framebuffer, viewport, scissor and blend state are restored afterwards.
+        /// @return the colour texture holding the content, 0 when the driver cannot render offscreen at this
+        /// size, draw the content directly instead
+        template<typename TRender>
+        GLuint render(uint64_t content, int width, int height, int cycle, TRender &&render) {
+            if (cycle != _cycle) {
+                _cycle = cycle;
+                collect();
+            }
+
+            entry *ent = find_entry(content, width, height);
+            if (ent == nullptr) {
+                ent = &create_entry(content, width, height);
+            }
+            ent->used_cycle = cycle;
+            if (ent->fbo == 0) {
+                // incomplete when created, retried once it has gone unused long enough to be collected
+                return 0;
+            }
+            if (ent->rendered_cycle == cycle) {
+                return ent->texture;
+            }
+
+            GLint draw_fbo, read_fbo, viewport[4];
+            glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &draw_fbo);
+            glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &read_fbo);
+            glGetIntegerv(GL_VIEWPORT, viewport);
+            GLboolean scissor = glIsEnabled(GL_SCISSOR_TEST);
+            GLint blend_src_rgb, blend_dst_rgb, blend_src_alpha, blend_dst_alpha;
+            glGetIntegerv(GL_BLEND_SRC_RGB, &blend_src_rgb);
+            glGetIntegerv(GL_BLEND_DST_RGB, &blend_dst_rgb);
+            glGetIntegerv(GL_BLEND_SRC_ALPHA, &blend_src_alpha);
+            glGetIntegerv(GL_BLEND_DST_ALPHA, &blend_dst_alpha);
+
+            glBindFramebuffer(GL_FRAMEBUFFER, ent->fbo);
+            glViewport(0, 0, width, height);
+            if (scissor) {
+                glDisable(GL_SCISSOR_TEST);
+            }
+
+            // leaves the clear colour alone
+            const GLfloat transparent[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+            glClearNamedFramebufferfv(ent->fbo, GL_COLOR, 0, transparent);
+
+            // blending onto transparent black with this leaves premultiplied colour
+            glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+            render();
+
+            glBlendFuncSeparate(blend_src_rgb, blend_dst_rgb, blend_src_alpha, blend_dst_alpha);
+            if (scissor) {
+                glEnable(GL_SCISSOR_TEST);
+            }
+            glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, draw_fbo);
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, read_fbo);
+
+            ent->rendered_cycle = cycle;
+            return ent->texture;
+        }
+
+        [[nodiscard]] size_t get_entry_count() const { return _entries.size(); }
+
+    private:
+        struct entry {
+            uint64_t content{};
+            int width{};
+            int height{};
+            GLuint fbo{};
+            GLuint texture{};
+            int rendered_cycle{-1};
+            int used_cycle{-1};
+        };
+
+        entry *find_entry(uint64_t content, int width, int height) {
+            // one entry per distinct display, a linear search is fine
+            for (entry &ent: _entries) {
+                if (ent.content == content && ent.width == width && ent.height == height) {
+                    return &ent;
+                }
+            }
+            return nullptr;
+        }
+
+        entry &create_entry(uint64_t content, int width, int height) {
+            entry ent{content, width, height};
+
+            glCreateTextures(GL_TEXTURE_2D, 1, &ent.texture);
+            glTextureStorage2D(ent.texture, 1, GL_RGBA8, width, height);
+            glTextureParameteri(ent.texture, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTextureParameteri(ent.texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTextureParameteri(ent.texture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTextureParameteri(ent.texture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+            glCreateFramebuffers(1, &ent.fbo);
+            glNamedFramebufferTexture(ent.fbo, GL_COLOR_ATTACHMENT0, ent.texture, 0);
+
+            GLenum status = glCheckNamedFramebufferStatus(ent.fbo, GL_FRAMEBUFFER);
+            if (status != GL_FRAMEBUFFER_COMPLETE) {
+                // called from the draw callbacks, so reported rather than thrown. The entry is kept
+                // without its objects so the failure is logged once rather than every frame
+                XPLMDebugString(std::format("Offscreen framebuffer {}x{} incomplete: {:#x}, drawing directly\n",
+                                            width, height, status).c_str());
+                release(ent);
+                ent.fbo = 0;
+                ent.texture = 0;
+            }
+
+            return _entries.emplace_back(ent);
+        }
+
+        /// release the entries nobody has asked for recently, a resized window leaves its old size behind
+        void collect() {
+            std::erase_if(_entries, [this](entry &ent) {
+                if (_cycle - ent.used_cycle <= _max_idle_cycles) {
+                    return false;
+                }
+                release(ent);
+                return true;
+            });
+        }
+
+        static void release(entry &ent) {
+            glDeleteFramebuffers(1, &ent.fbo);
+            glDeleteTextures(1, &ent.texture);
+        }
+
+    private:
+        int _max_idle_cycles;
+        int _cycle{-1};
+        std::vector<entry> _entries;
+    };
+}
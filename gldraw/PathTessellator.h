@@ -0,0 +1,460 @@
+//
+// Created by icarr on 17/10/2026.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include <gldraw/BufferValidator.h>
+#include <gldraw/VertexManager.h>
+#include <gldraw/colour.h>
+#include <gldraw/geom.h>
+#include <gldraw/quad_indices.h>
+#include <gldraw/vertex_layout.h>
+#include <glmath/matrices.h>
+#include <glmath/vectors.h>
+
+namespace gldraw {
+    enum class line_join {
+        miter,
+        round,
+        bevel
+    };
+
+    enum class line_cap {
+        butt,
+        square,
+        round
+    };
+
+    struct stroke_style {
+        float width{1.0f};
+        line_join join{line_join::miter};
+        line_cap cap{line_cap::butt};
+        /// miters reaching further than this many half widths from the corner are bevelled
+        float miter_limit{4.0f};
+    };
+
+    /// triangles in path units, wound for DEFAULT_WINDING
+    struct path_mesh {
+        std::vector<glmath::vec2f> positions;
+        std::vector<unsigned int> indices;
+    };
+
+    /// Turns strokes, arcs, sectors and rounded rects into triangles for VertexManager::add_triangles.
+    /// Curves are split so no chord strays more than tolerance pixels from the curve at the given
+    /// pixel_scale, so a dial gets more segments as it grows on screen. Meshes are remembered by their
+    /// parameters: a static dial face is tessellated once and a moving needle keeps its mesh, only the
+    /// transform given to add_mesh or update_mesh changes.
+    class PathTessellator {
+    public:
+        /// @param tolerance the furthest a chord may stray from its curve, in pixels
+        /// @param max_entries meshes remembered, all are dropped when it is reached
+        explicit PathTessellator(float tolerance = 0.25f, size_t max_entries = 1024) :
+                _tolerance(tolerance), _max_entries(max_entries) {}
+
+        PathTessellator(const PathTessellator &other) = delete;
+        PathTessellator &operator=(const PathTessellator &other) = delete;
+
+        struct statistics {
+            size_t hits{};
+            size_t misses{};
+            size_t entries{};
+        };
+
+    public:
+        /// a stroke along points, joined back to the first point when closed. Like every mesh returned
+        /// here it is valid until the next call
+        /// @param pixel_scale screen pixels per path unit
+        const path_mesh &polyline(std::span<const glmath::vec2f> points, const stroke_style &style,
+                                  bool closed = false, float pixel_scale = 1.0f) {
+            const int round_segments = segments(style.width / 2.0f, 2.0f * std::numbers::pi_v<float>, pixel_scale);
+            begin_key(shape::polyline);
+            add_key(style, round_segments);
+            add_key(static_cast<float>(closed));
+            for (const glmath::vec2f &point: points) {
+                add_key(point.x, point.y);
+            }
+            if (path_mesh *mesh = find_mesh()) {
+                return *mesh;
+            }
+
+            path_mesh &mesh = store_mesh();
+            stroke(mesh, points, style, closed, round_segments);
+            return mesh;
+        }
+
+        /// a stroke along a circular arc, angles in radians counter clockwise from +x
+        const path_mesh &arc(glmath::vec2f centre, float radius, float start_angle, float end_angle,
+                             const stroke_style &style, float pixel_scale = 1.0f) {
+            const float sweep = end_angle - start_angle;
+            const int arc_segments = segments(radius + style.width / 2.0f, std::abs(sweep), pixel_scale);
+            const int round_segments = segments(style.width / 2.0f, 2.0f * std::numbers::pi_v<float>, pixel_scale);
+            begin_key(shape::arc);
+            add_key(style, round_segments);
+            add_key(centre.x, centre.y, radius, start_angle, end_angle, static_cast<float>(arc_segments));
+            if (path_mesh *mesh = find_mesh()) {
+                return *mesh;
+            }
+
+            const bool full_circle = std::abs(sweep) >= 2.0f * std::numbers::pi_v<float>;
+            _points.clear();
+            for (int segment = 0; segment <= arc_segments - (full_circle ? 1 : 0); ++segment) {
+                _points.push_back(on_circle(centre, radius, start_angle + sweep * segment / arc_segments));
+            }
+
+            path_mesh &mesh = store_mesh();
+            stroke(mesh, _points, style, full_circle, round_segments);
+            return mesh;
+        }
+
+        /// a filled pie slice, or a ring slice when inner_radius is above 0
+        const path_mesh &sector(glmath::vec2f centre, float inner_radius, float outer_radius, float start_angle,
+                                float end_angle, float pixel_scale = 1.0f) {
+            const float sweep = end_angle - start_angle;
+            const int arc_segments = segments(outer_radius, std::abs(sweep), pixel_scale);
+            begin_key(shape::sector);
+            add_key(centre.x, centre.y, inner_radius, outer_radius, start_angle, end_angle);
+            add_key(static_cast<float>(arc_segments));
+            if (path_mesh *mesh = find_mesh()) {
+                return *mesh;
+            }
+
+            path_mesh &mesh = store_mesh();
+            if (inner_radius <= 0.0f) {
+                fan(mesh, centre, outer_radius, start_angle, sweep, arc_segments);
+                return mesh;
+            }
+
+            // a strip of inner and outer points
+            for (int segment = 0; segment <= arc_segments; ++segment) {
+                const float angle = start_angle + sweep * segment / arc_segments;
+                add_vertex(mesh, on_circle(centre, inner_radius, angle));
+                add_vertex(mesh, on_circle(centre, outer_radius, angle));
+                if (segment > 0) {
+                    const auto outer = static_cast<unsigned int>(mesh.positions.size() - 1);
+                    add_triangle(mesh, outer - 3, outer - 2, outer);
+                    add_triangle(mesh, outer - 3, outer, outer - 1);
+                }
+            }
+            return mesh;
+        }
+
+        /// a filled rect with circular corners, the radius is limited to half the shorter side
+        const path_mesh &rounded_rect(const gldraw::rect &rct, float corner_radius, float pixel_scale = 1.0f) {
+            const float radius = std::clamp(corner_radius, 0.0f, std::min(rct.size.x, rct.size.y) / 2.0f);
+            const int corner_segments = segments(radius, std::numbers::pi_v<float> / 2.0f, pixel_scale);
+            begin_key(shape::rounded_rect);
+            add_key(rct.pos.x, rct.pos.y, rct.size.x, rct.size.y, radius, static_cast<float>(corner_segments));
+            if (path_mesh *mesh = find_mesh()) {
+                return *mesh;
+            }
+
+            path_mesh &mesh = store_mesh();
+            const glmath::vec2f rect_max = rct.pos + rct.size;
+            if (radius <= 0.0f) {
+                const unsigned int bl = add_vertex(mesh, rct.pos);
+                const unsigned int tl = add_vertex(mesh, {rct.pos.x, rect_max.y});
+                const unsigned int tr = add_vertex(mesh, rect_max);
+                const unsigned int br = add_vertex(mesh, {rect_max.x, rct.pos.y});
+                add_triangle(mesh, bl, br, tl);
+                add_triangle(mesh, tl, br, tr);
+                return mesh;
+            }
+
+            // the outline is convex, fan it from the middle
+            const unsigned int middle = add_vertex(mesh, rct.pos + rct.size * 0.5f);
+            const glmath::vec2f corners[4] = {{rect_max.x - radius, rct.pos.y + radius},
+                                              {rect_max.x - radius, rect_max.y - radius},
+                                              {rct.pos.x + radius, rect_max.y - radius},
+                                              {rct.pos.x + radius, rct.pos.y + radius}};
+            // br, tr, tl, bl each sweeping a quarter turn counter clockwise
+            const auto first = static_cast<unsigned int>(mesh.positions.size());
+            for (int corner = 0; corner < 4; ++corner) {
+                const float start_angle = (corner - 1) * std::numbers::pi_v<float> / 2.0f;
+                for (int segment = 0; segment <= corner_segments; ++segment) {
+                    add_vertex(mesh, on_circle(corners[corner], radius,
+                                               start_angle + std::numbers::pi_v<float> / 2.0f * segment / corner_segments));
+                }
+            }
+            const auto last = static_cast<unsigned int>(mesh.positions.size());
+            for (unsigned int indx = first; indx < last; ++indx) {
+                add_triangle(mesh, middle, indx, indx + 1 < last ? indx + 1 : first);
+            }
+            return mesh;
+        }
+
+        /// Append mesh to manager in colour, moved by transform.
+        /// @return the first vertex, for update_mesh
+        template<vertex_layout TVertex>
+        size_t add_mesh(VertexManager<TVertex> &manager, const path_mesh &mesh, const gldraw::colour &colour,
+                        const glmath::mat4x4 &transform = glmath::mat4x4::identity) {
+            std::vector<TVertex> vertices = make_vertices<TVertex>(mesh, colour, transform);
+            return manager.add_triangles(vertices, mesh.indices);
+        }
+
+        /// move or recolour a mesh added by add_mesh in place, only its vertices are uploaded again
+        template<vertex_layout TVertex>
+        void update_mesh(VertexManager<TVertex> &manager, size_t first_vertex, const path_mesh &mesh,
+                         const gldraw::colour &colour, const glmath::mat4x4 &transform) {
+            std::vector<TVertex> vertices = make_vertices<TVertex>(mesh, colour, transform);
+            manager.update_vertices(first_vertex, vertices);
+        }
+
+        [[nodiscard]] statistics get_statistics() const { return {_hits, _misses, _meshes.size()}; }
+
+        void clear() { _meshes.clear(); }
+
+    private:
+        enum class shape {
+            polyline,
+            arc,
+            sector,
+            rounded_rect
+        };
+
+        struct cache_entry {
+            std::vector<float> key;
+            path_mesh mesh;
+        };
+
+        /// chords needed to keep within tolerance of a radius arc sweeping through sweep radians
+        [[nodiscard]] int segments(float radius, float sweep, float pixel_scale) const {
+            const float radius_px = radius * pixel_scale;
+            if (radius_px <= _tolerance || sweep <= 0.0f) {
+                return 1;
+            }
+            const float max_step = 2.0f * std::acos(1.0f - _tolerance / radius_px);
+            return std::clamp(static_cast<int>(std::ceil(sweep / max_step)), 1, MAX_SEGMENTS);
+        }
+
+        static glmath::vec2f on_circle(glmath::vec2f centre, float radius, float angle) {
+            return {centre.x + radius * std::cos(angle), centre.y + radius * std::sin(angle)};
+        }
+
+        static unsigned int add_vertex(path_mesh &mesh, glmath::vec2f position) {
+            mesh.positions.push_back(position);
+            return static_cast<unsigned int>(mesh.positions.size() - 1);
+        }
+
+        /// add a triangle turned to face forward whichever way its corners were given
+        static void add_triangle(path_mesh &mesh, unsigned int a, unsigned int b, unsigned int c) {
+            const glmath::vec2f ab = mesh.positions[b] - mesh.positions[a];
+            const glmath::vec2f ac = mesh.positions[c] - mesh.positions[a];
+            const bool ccw = ab.x * ac.y - ab.y * ac.x >= 0.0f;
+            if (ccw != (DEFAULT_WINDING == winding::ccw)) {
+                std::swap(b, c);
+            }
+            mesh.indices.insert(mesh.indices.end(), {a, b, c});
+        }
+
+        /// triangles from centre to an arc of radius
+        static void fan(path_mesh &mesh, glmath::vec2f centre, float radius, float start_angle, float sweep, int fan_segments) {
+            const unsigned int middle = add_vertex(mesh, centre);
+            for (int segment = 0; segment <= fan_segments; ++segment) {
+                add_vertex(mesh, on_circle(centre, radius, start_angle + sweep * segment / fan_segments));
+                if (segment > 0) {
+                    const auto last = static_cast<unsigned int>(mesh.positions.size() - 1);
+                    add_triangle(mesh, middle, last - 1, last);
+                }
+            }
+        }
+
+        static glmath::vec2f left_normal(glmath::vec2f direction) {
+            return {-direction.y, direction.x};
+        }
+
+        /// Each segment is a quad, the outside of each corner is filled by the join and open ends get
+        /// their caps. Overlaps on the inside of corners are left, strokes are drawn opaque.
+        void stroke(path_mesh &mesh, std::span<const glmath::vec2f> points, const stroke_style &style, bool closed,
+                    int round_segments) {
+            // repeated points have no direction
+            _stroke_points.clear();
+            for (const glmath::vec2f &point: points) {
+                if (_stroke_points.empty() || (point - _stroke_points.back()).magnitude2() > 1.0e-12f) {
+                    _stroke_points.push_back(point);
+                }
+            }
+            if (closed && _stroke_points.size() > 2 && (_stroke_points.front() - _stroke_points.back()).magnitude2() <= 1.0e-12f) {
+                _stroke_points.pop_back();
+            }
+            const size_t point_count = _stroke_points.size();
+            if (point_count < 2) {
+                return;
+            }
+            closed = closed && point_count > 2;
+
+            const float half = style.width / 2.0f;
+            const size_t segment_count = closed ? point_count : point_count - 1;
+            _directions.resize(segment_count);
+            for (size_t segment = 0; segment < segment_count; ++segment) {
+                _directions[segment] = (_stroke_points[(segment + 1) % point_count] - _stroke_points[segment]).normalize();
+            }
+
+            for (size_t segment = 0; segment < segment_count; ++segment) {
+                const glmath::vec2f direction = _directions[segment];
+                const glmath::vec2f offset = left_normal(direction) * half;
+                glmath::vec2f start = _stroke_points[segment];
+                glmath::vec2f end = _stroke_points[(segment + 1) % point_count];
+                if (!closed && style.cap == line_cap::square) {
+                    if (segment == 0) {
+                        start = start - direction * half;
+                    }
+                    if (segment == segment_count - 1) {
+                        end = end + direction * half;
+                    }
+                }
+
+                const unsigned int start_left = add_vertex(mesh, start + offset);
+                const unsigned int start_right = add_vertex(mesh, start - offset);
+                const unsigned int end_right = add_vertex(mesh, end - offset);
+                const unsigned int end_left = add_vertex(mesh, end + offset);
+                add_triangle(mesh, start_left, start_right, end_right);
+                add_triangle(mesh, start_left, end_right, end_left);
+            }
+
+            // the corners between segments, every point of a closed stroke is one
+            const size_t first_join = closed ? 0 : 1;
+            const size_t last_join = closed ? point_count : point_count - 1;
+            for (size_t point = first_join; point < last_join; ++point) {
+                const glmath::vec2f in = _directions[(point + segment_count - 1) % segment_count];
+                const glmath::vec2f out = _directions[point % segment_count];
+                join(mesh, _stroke_points[point], in, out, half, style, round_segments);
+            }
+
+            if (!closed && style.cap == line_cap::round) {
+                const float pi = std::numbers::pi_v<float>;
+                const glmath::vec2f start_normal = left_normal(_directions.front());
+                const glmath::vec2f end_normal = left_normal(_directions.back());
+                // half turns from one side round the back of the end to the other
+                fan(mesh, _stroke_points.front(), half, std::atan2(start_normal.y, start_normal.x), pi,
+                    std::max(1, round_segments / 2));
+                fan(mesh, _stroke_points.back(), half, std::atan2(-end_normal.y, -end_normal.x), pi,
+                    std::max(1, round_segments / 2));
+            }
+        }
+
+        static void join(path_mesh &mesh, glmath::vec2f corner, glmath::vec2f in, glmath::vec2f out, float half,
+                         const stroke_style &style, int round_segments) {
+            const float turn = in.x * out.y - in.y * out.x;
+            if (std::abs(turn) < 1.0e-6f && in.dot(out) > 0.0f) {
+                // straight on, the segments already meet
+                return;
+            }
+
+            // a left turn opens a gap on the right
+            const float side = turn > 0.0f ? -1.0f : 1.0f;
+            const glmath::vec2f in_normal = left_normal(in) * side;
+            const glmath::vec2f out_normal = left_normal(out) * side;
+
+            const unsigned int centre = add_vertex(mesh, corner);
+            const unsigned int in_edge = add_vertex(mesh, corner + in_normal * half);
+            const unsigned int out_edge = add_vertex(mesh, corner + out_normal * half);
+
+            if (style.join == line_join::round) {
+                const float start_angle = std::atan2(in_normal.y, in_normal.x);
+                float sweep = std::atan2(out_normal.y, out_normal.x) - start_angle;
+                const float pi = std::numbers::pi_v<float>;
+                sweep = sweep > pi ? sweep - 2.0f * pi : sweep < -pi ? sweep + 2.0f * pi : sweep;
+                const int join_segments = std::max(1, static_cast<int>(std::ceil(round_segments * std::abs(sweep) / (2.0f * pi))));
+                unsigned int previous = in_edge;
+                for (int segment = 1; segment < join_segments; ++segment) {
+                    const unsigned int next = add_vertex(mesh, on_circle(corner, half, start_angle + sweep * segment / join_segments));
+                    add_triangle(mesh, centre, previous, next);
+                    previous = next;
+                }
+                add_triangle(mesh, centre, previous, out_edge);
+                return;
+            }
+
+            if (style.join == line_join::miter) {
+                // the miter tip is where the two outer edges meet
+                const float denominator = 1.0f + in_normal.dot(out_normal);
+                if (denominator > 1.0e-6f) {
+                    const glmath::vec2f tip = (in_normal + out_normal) * (half / denominator);
+                    if (tip.magnitude2() <= style.miter_limit * style.miter_limit * half * half) {
+                        const unsigned int tip_vertex = add_vertex(mesh, corner + tip);
+                        add_triangle(mesh, centre, in_edge, tip_vertex);
+                        add_triangle(mesh, centre, tip_vertex, out_edge);
+                        return;
+                    }
+                }
+            }
+
+            add_triangle(mesh, centre, in_edge, out_edge);
+        }
+
+        template<vertex_layout TVertex>
+        static std::vector<TVertex> make_vertices(const path_mesh &mesh, const gldraw::colour &colour,
+                                                  const glmath::mat4x4 &transform) {
+            std::vector<TVertex> vertices;
+            vertices.reserve(mesh.positions.size());
+            for (const glmath::vec2f &position: mesh.positions) {
+                vertices.push_back(TVertex(position, {0.0f, 0.0f}, colour));
+                vertices.back().apply_transform(transform);
+            }
+            return vertices;
+        }
+
+        void begin_key(shape kind) {
+            _key.clear();
+            _key.push_back(static_cast<float>(kind));
+        }
+
+        template<typename... TValues>
+        void add_key(TValues... values) {
+            (_key.push_back(static_cast<float>(values)), ...);
+        }
+
+        void add_key(const stroke_style &style, int round_segments) {
+            add_key(style.width, static_cast<int>(style.join), static_cast<int>(style.cap), style.miter_limit, round_segments);
+        }
+
+        path_mesh *find_mesh() {
+            _key_hash = hash_bytes(_key.data(), _key.size() * sizeof(float));
+            auto found = _meshes.find(_key_hash);
+            if (found != _meshes.end() && found->second.key == _key) {
+                ++_hits;
+                return &found->second.mesh;
+            }
+            ++_misses;
+            return nullptr;
+        }
+
+        /// an empty mesh stored under the key of the last find_mesh
+        path_mesh &store_mesh() {
+            if (_meshes.size() >= _max_entries) {
+                _meshes.clear();
+            }
+            cache_entry &entry = _meshes[_key_hash];
+            entry.key = _key;
+            entry.mesh.positions.clear();
+            entry.mesh.indices.clear();
+            return entry.mesh;
+        }
+
+    private:
+        static constexpr int MAX_SEGMENTS = 1024;
+
+        float _tolerance;
+        size_t _max_entries;
+
+        std::unordered_map<uint64_t, cache_entry> _meshes;
+        std::vector<float> _key;
+        uint64_t _key_hash{};
+        size_t _hits{};
+        size_t _misses{};
+
+        // working storage kept between calls
+        std::vector<glmath::vec2f> _points;
+        std::vector<glmath::vec2f> _stroke_points;
+        std::vector<glmath::vec2f> _directions;
+    };
+}
@@ -0,0 +1,219 @@
+//
+// Created by icarr on 17/10/2026.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+#include <glad/gl.h>
+
+namespace gldraw {
+    /// Decides which cached renders are refreshed this sim frame. Each render is identified by a key,
+    /// its content and size, as displays showing the same content share one render; it refreshes at
+    /// the fastest target rate of the displays showing it and between refreshes the cached texture is
+    /// composited again. Renders bracketed by begin_render/end_render are timed on the CPU and with
+    /// GPU timestamp queries, and every rate is scaled down while the average cost per sim frame is
+    /// over budget, then back up once there is room again.
+    class RefreshScheduler {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        struct statistics {
+            /// average milliseconds per sim frame over the last evaluation window
+            double cpu_ms{};
+            double gpu_ms{};
+            /// multiplier applied to every target rate
+            float rate_scale{1.0f};
+        };
+
+    public:
+        /// @param budget_ms render time per sim frame to stay within, on the CPU and on the GPU
+        /// @param min_hz no display drops below this however far over budget
+        explicit RefreshScheduler(double budget_ms = 2.0, float min_hz = 2.0f) :
+                _budget_ms(budget_ms), _min_hz(min_hz) {}
+
+        ~RefreshScheduler() {
+            for (const gpu_sample &sample: _gpu_samples) {
+                _free_queries.push_back(sample.begin);
+                _free_queries.push_back(sample.end);
+            }
+            if (!_free_queries.empty()) {
+                glDeleteQueries(static_cast<GLsizei>(_free_queries.size()), _free_queries.data());
+            }
+        }
+
+        RefreshScheduler(const RefreshScheduler &other) = delete;
+        RefreshScheduler &operator=(const RefreshScheduler &other) = delete;
+
+    public:
+        void set_budget(double budget_ms) { _budget_ms = budget_ms; }
+        [[nodiscard]] double get_budget() const { return _budget_ms; }
+
+        [[nodiscard]] statistics get_statistics() const { return _stats; }
+
+        /// True when a display should re-render the content under key rather than composite its cached
+        /// texture. Every display showing the content asks each sim frame, whichever display is drawn
+        /// first once it is due renders it for all of them.
+        /// @param target_hz the asking display's rate, 0 re-renders every sim frame and is never throttled
+        bool is_due(uint64_t key, float target_hz, int cycle) {
+            advance(cycle);
+
+            render_state &state = _renders[key];
+            if (state.seen_cycle != cycle) {
+                // the displays are drawn in turn, the fastest of the last frame stands in for any still to ask
+                state.previous_hz = state.seen_cycle == cycle - 1 ? state.fastest_hz : 0.0f;
+                state.fastest_hz = 0.0f;
+                state.seen_cycle = cycle;
+            }
+            state.fastest_hz = std::max(state.fastest_hz, target_hz > 0.0f ? target_hz : EVERY_FRAME);
+
+            if (state.rendered_cycle == cycle) {
+                // already refreshed for another display this frame
+                return false;
+            }
+            const float fastest_hz = std::max(state.fastest_hz, state.previous_hz);
+            if (fastest_hz == EVERY_FRAME || state.last_render == clock::time_point{}) {
+                return true;
+            }
+            const float hz = std::max(_min_hz, fastest_hz * _stats.rate_scale);
+            return clock::now() - state.last_render >= std::chrono::duration<float>(1.0f / hz);
+        }
+
+        /// mark the start of a render of the content under key, on the GL thread, only the display
+        /// actually rendering it brackets the work
+        void begin_render(uint64_t key) {
+            assert(!_rendering);
+            _rendering = true;
+
+            _cpu_start = clock::now();
+            render_state &state = _renders[key];
+            state.last_render = _cpu_start;
+            state.rendered_cycle = _cycle;
+
+            _current.begin = acquire_query();
+            _current.end = acquire_query();
+            glQueryCounter(_current.begin, GL_TIMESTAMP);
+        }
+
+        void end_render() {
+            assert(_rendering);
+            _rendering = false;
+
+            glQueryCounter(_current.end, GL_TIMESTAMP);
+            _gpu_samples.push_back(_current);
+
+            _cpu_sum_ms += std::chrono::duration<double, std::milli>(clock::now() - _cpu_start).count();
+        }
+
+    private:
+        struct render_state {
+            // fastest rate of the displays asking this sim frame and the one before
+            float fastest_hz{};
+            float previous_hz{};
+            int seen_cycle{-1};
+            int rendered_cycle{-1};
+            clock::time_point last_render{};
+        };
+
+        struct gpu_sample {
+            GLuint begin{};
+            GLuint end{};
+        };
+
+        // sim frames averaged before the rates are adjusted
+        static constexpr int EVALUATION_FRAMES = 30;
+        // sim frames a key goes unasked before it is forgotten, a resized window leaves its old size behind
+        static constexpr int STALE_FRAMES = 120;
+        static constexpr float EVERY_FRAME = std::numeric_limits<float>::infinity();
+
+        /// once per sim frame: collect finished GPU timings and adjust the rates every evaluation window
+        void advance(int cycle) {
+            if (cycle == _cycle) {
+                return;
+            }
+            _cycle = cycle;
+
+            collect_gpu_samples();
+
+            std::erase_if(_renders, [cycle](const auto &entry) {
+                return cycle - entry.second.seen_cycle > STALE_FRAMES;
+            });
+
+            if (++_frames < EVALUATION_FRAMES) {
+                return;
+            }
+
+            _stats.cpu_ms = _cpu_sum_ms / _frames;
+            _stats.gpu_ms = _gpu_sum_ms / _frames;
+            _frames = 0;
+            _cpu_sum_ms = 0.0;
+            _gpu_sum_ms = 0.0;
+
+            // back off quickly when over, recover slowly so the rates do not oscillate
+            const double load = std::max(_stats.cpu_ms, _stats.gpu_ms) / _budget_ms;
+            if (load > 1.0) {
+                _stats.rate_scale = std::max(0.05f, _stats.rate_scale * static_cast<float>(std::max(0.5, 1.0 / load)));
+            } else if (load < 0.7) {
+                _stats.rate_scale = std::min(1.0f, _stats.rate_scale * 1.1f);
+            }
+        }
+
+        /// timings whose queries have completed, in submission order, never waits
+        void collect_gpu_samples() {
+            while (!_gpu_samples.empty()) {
+                gpu_sample &sample = _gpu_samples.front();
+                GLint available = GL_FALSE;
+                glGetQueryObjectiv(sample.end, GL_QUERY_RESULT_AVAILABLE, &available);
+                if (!available) {
+                    break;
+                }
+
+                GLuint64 begin_ns, end_ns;
+                glGetQueryObjectui64v(sample.begin, GL_QUERY_RESULT, &begin_ns);
+                glGetQueryObjectui64v(sample.end, GL_QUERY_RESULT, &end_ns);
+                _gpu_sum_ms += static_cast<double>(end_ns - begin_ns) / 1.0e6;
+
+                _free_queries.push_back(sample.begin);
+                _free_queries.push_back(sample.end);
+                _gpu_samples.pop_front();
+            }
+        }
+
+        GLuint acquire_query() {
+            if (_free_queries.empty()) {
+                GLuint query;
+                glGenQueries(1, &query);
+                return query;
+            }
+            GLuint query = _free_queries.back();
+            _free_queries.pop_back();
+            return query;
+        }
+
+    private:
+        double _budget_ms;
+        float _min_hz;
+
+        std::unordered_map<uint64_t, render_state> _renders;
+
+        int _cycle{-1};
+        int _frames{};
+        double _cpu_sum_ms{};
+        double _gpu_sum_ms{};
+        statistics _stats;
+
+        bool _rendering{};
+        clock::time_point _cpu_start;
+        gpu_sample _current;
+        std::deque<gpu_sample> _gpu_samples;
+        std::vector<GLuint> _free_queries;
+    };
+}
@@ -0,0 +1,195 @@
+//
+// Created by icarr on 17/10/2026.
+//
+
+#pragma once
+
+#include <cassert>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <glad/gl.h>
+
+#include <glmath/matrices.h>
+
+namespace gldraw {
+    /// Shadow of the GL state the plugin sets while rendering, so redundant calls and blocking queries
+    /// are skipped. Uniform locations and values are cached per program, those persist as nobody else
+    /// uses our programs. Bindings are context wide and X-Plane changes them between our callbacks, so
+    /// they are only trusted within a pass, from begin_pass to end_pass.
+    class RenderState {
+    public:
+        struct blend_func {
+            GLint src_rgb{GL_SRC_ALPHA};
+            GLint dst_rgb{GL_ONE_MINUS_SRC_ALPHA};
+            GLint src_alpha{GL_SRC_ALPHA};
+            GLint dst_alpha{GL_ONE_MINUS_SRC_ALPHA};
+
+            bool operator==(const blend_func &rhs) const = default;
+        };
+
+    public:
+        RenderState() = default;
+
+        RenderState(const RenderState &other) = delete;
+        RenderState &operator=(const RenderState &other) = delete;
+
+    public:
+        /// start rendering from a callback. X-Plane's front face is queried every pass, the avionics and
+        /// window callbacks run in different phases of its frame which need not share one. Its blend
+        /// function is only queried by a pass that changes it
+        void begin_pass() {
+            assert(!_in_pass);
+            _in_pass = true;
+
+            // X-Plane has had the context since the last pass
+            _program = 0;
+            _program_known = false;
+
+            glGetIntegerv(GL_FRONT_FACE, &_host_front_face);
+            _front_face = _host_front_face;
+
+            _blend_known = false;
+        }
+
+        /// restore the state X-Plane expects before the callback returns
+        void end_pass() {
+            assert(_in_pass);
+            _in_pass = false;
+
+            set_front_face(_host_front_face);
+            if (_blend_known) {
+                set_blend_func(_host_blend);
+            }
+        }
+
+        /// the front face X-Plane had set when the pass began
+        [[nodiscard]] GLint get_host_front_face() const { return _host_front_face; }
+
+        void set_front_face(GLint front_face) {
+            if (front_face != _front_face) {
+                glFrontFace(front_face);
+                _front_face = front_face;
+            }
+        }
+
+        /// the blend function X-Plane had set when the pass began
+        [[nodiscard]] const blend_func &get_host_blend_func() {
+            capture_host_blend();
+            return _host_blend;
+        }
+
+        void set_blend_func(const blend_func &blend) {
+            assert(_in_pass);
+            capture_host_blend();
+            if (blend != _blend) {
+                glBlendFuncSeparate(blend.src_rgb, blend.dst_rgb, blend.src_alpha, blend.dst_alpha);
+                _blend = blend;
+            }
+        }
+
+        /// the same factors for colour and alpha
+        void set_blend_func(GLint src, GLint dst) {
+            set_blend_func({src, dst, src, dst});
+        }
+
+        void use_program(GLuint program) {
+            assert(_in_pass);
+            if (!_program_known || program != _program) {
+                glUseProgram(program);
+                _program = program;
+                _program_known = true;
+            }
+        }
+
+        /// location of a uniform of the current program, looked up on first use
+        GLint uniform_location(const char *name) {
+            return find_uniform(name).location;
+        }
+
+        /// set a sampler or int uniform of the current program if it differs from the last value set
+        void set_uniform(const char *name, GLint value) {
+            uniform_entry &entry = find_uniform(name);
+            if (entry.location < 0 || (entry.has_value && entry.int_value == value)) {
+                return;
+            }
+            glUniform1i(entry.location, value);
+            entry.int_value = value;
+            entry.has_value = true;
+        }
+
+        /// set a mat4 uniform of the current program if it differs from the last value set
+        void set_uniform(const char *name, const glmath::mat4x4 &value) {
+            uniform_entry &entry = find_uniform(name);
+            if (entry.location < 0 ||
+                (entry.has_value && std::memcmp(entry.matrix_value, value.as_pointer_to_float(), sizeof(entry.matrix_value)) == 0)) {
+                return;
+            }
+            glUniformMatrix4fv(entry.location, 1, GL_FALSE, value.as_pointer_to_float());
+            std::memcpy(entry.matrix_value, value.as_pointer_to_float(), sizeof(entry.matrix_value));
+            entry.has_value = true;
+        }
+
+        /// forget everything known about program, call before deleting or relinking it
+        void forget_program(GLuint program) {
+            _uniforms.erase(program);
+            if (program == _program) {
+                _program_known = false;
+            }
+        }
+
+    private:
+        /// read X-Plane's blend function the first time a pass needs it
+        void capture_host_blend() {
+            if (_blend_known) {
+                return;
+            }
+            glGetIntegerv(GL_BLEND_SRC_RGB, &_host_blend.src_rgb);
+            glGetIntegerv(GL_BLEND_DST_RGB, &_host_blend.dst_rgb);
+            glGetIntegerv(GL_BLEND_SRC_ALPHA, &_host_blend.src_alpha);
+            glGetIntegerv(GL_BLEND_DST_ALPHA, &_host_blend.dst_alpha);
+            _blend = _host_blend;
+            _blend_known = true;
+        }
+
+        struct uniform_entry {
+            std::string name;
+            GLint location{-1};
+            bool has_value{};
+            GLint int_value{};
+            float matrix_value[16]{};
+        };
+
+        uniform_entry &find_uniform(const char *name) {
+            assert(_program_known && _program != 0);
+
+            // a handful of uniforms per program, a linear search beats hashing the name
+            std::vector<uniform_entry> &entries = _uniforms[_program];
+            for (uniform_entry &entry: entries) {
+                if (entry.name == name) {
+                    return entry;
+                }
+            }
+
+            uniform_entry &entry = entries.emplace_back();
+            entry.name = name;
+            entry.location = glGetUniformLocation(_program, name);
+            return entry;
+        }
+
+    private:
+        bool _in_pass{};
+        GLint _host_front_face{GL_CCW};
+        GLint _front_face{GL_CCW};
+        blend_func _host_blend{};
+        blend_func _blend{};
+        bool _blend_known{};
+
+        GLuint _program{};
+        bool _program_known{};
+
+        std::unordered_map<GLuint, std::vector<uniform_entry>> _uniforms;
+    };
+}
@@ -0,0 +1,268 @@
+//
+// Created by icarr on 17/10/2026.
+//
+
+#include <algorithm>
+#include <charconv>
+#include <deque>
+#include <fstream>
+#include <future>
+#include <system_error>
+
+#include <gldraw/temp_file.h>
+#include <gldraw/worker_pool.h>
+
+#include "ResourceIndex.h"
+
+namespace gldraw {
+    namespace {
+        constexpr std::string_view CACHE_HEADER = "minimal_plugin resource index 1";
+
+        using directory_map = ResourceIndex::directory_map;
+        using directory_record = ResourceIndex::directory_record;
+
+        std::string child_path(const std::string &parent, const std::string &name) {
+            return parent.empty() ? name : parent + "/" + name;
+        }
+
+        std::pair<size_t, std::string_view> path_order(const std::string &path) {
+            return {std::count(path.begin(), path.end(), '/'), path};
+        }
+
+        /// the record for directory rel, reused from previous when its modification time is unchanged
+        /// @return false when the directory cannot be read
+        bool visit_directory(const std::filesystem::path &root, const std::string &rel, const directory_map &previous,
+                             directory_record &record, bool &listed) {
+            std::error_code ec;
+            const std::filesystem::path dir = rel.empty() ? root : root / std::filesystem::path(rel);
+
+            std::filesystem::file_time_type mtime = std::filesystem::last_write_time(dir, ec);
+            if (ec) {
+                return false;
+            }
+            record.mtime = mtime.time_since_epoch().count();
+
+            auto found = previous.find(rel);
+            if (found != previous.end() && found->second.mtime == record.mtime) {
+                // nothing was added, removed or renamed directly inside it
+                record.files = found->second.files;
+                record.subdirectories = found->second.subdirectories;
+                listed = false;
+                return true;
+            }
+
+            listed = true;
+            for (std::filesystem::directory_iterator it(dir, std::filesystem::directory_options::skip_permission_denied, ec), end;
+                 !ec && it != end; it.increment(ec)) {
+                std::string name = it->path().filename().string();
+                if (name.find('\n') != std::string::npos) {
+                    // cannot be written to the line based cache
+                    continue;
+                }
+                // directory links are not followed, as recursive_directory_iterator does by default
+                if (it->is_directory(ec) && !it->is_symlink(ec)) {
+                    record.subdirectories.push_back(std::move(name));
+                } else if (!it->is_directory(ec)) {
+                    record.files.push_back(std::move(name));
+                }
+            }
+            return true;
+        }
+
+        /// depth first walk of the subtree at rel into directories
+        /// @return the number of directories listed rather than reused
+        size_t walk_subtree(const std::filesystem::path &root, const std::string &rel, const directory_map &previous,
+                            directory_map &directories) {
+            size_t listed_count = 0;
+            std::vector<std::string> pending{rel};
+            while (!pending.empty()) {
+                std::string current = std::move(pending.back());
+                pending.pop_back();
+
+                directory_record record;
+                bool listed;
+                if (!visit_directory(root, current, previous, record, listed)) {
+                    continue;
+                }
+                listed_count += listed ? 1 : 0;
+
+                for (const std::string &subdirectory: record.subdirectories) {
+                    pending.push_back(child_path(current, subdirectory));
+                }
+                directories.emplace(std::move(current), std::move(record));
+            }
+            return listed_count;
+        }
+    }
+
+    ResourceIndex::ResourceIndex(std::filesystem::path root, std::filesystem::path cache_file) :
+            _root(std::move(root)), _cache_file(std::move(cache_file)) {}
+
+    void ResourceIndex::refresh(unsigned int thread_count) {
+        directory_map previous;
+        if (!_cache_file.empty()) {
+            load(previous);
+        }
+        // also refreshing an index already in memory
+        previous.merge(_directories);
+        _directories.clear();
+
+        _stats = {};
+
+        // list the top of the tree here until there is enough independent work to spread over the threads
+        worker_pool workers(thread_count);
+        const size_t wanted_subtrees = 4 * workers.get_thread_count();
+
+        std::deque<std::string> frontier{""};
+        for (int depth = 0; depth < 3 && !frontier.empty() && frontier.size() < wanted_subtrees; ++depth) {
+            for (size_t count = frontier.size(); count > 0; --count) {
+                std::string current = std::move(frontier.front());
+                frontier.pop_front();
+
+                directory_record record;
+                bool listed;
+                if (!visit_directory(_root, current, previous, record, listed)) {
+                    continue;
+                }
+                _stats.listed_count += listed ? 1 : 0;
+
+                for (const std::string &subdirectory: record.subdirectories) {
+                    frontier.push_back(child_path(current, subdirectory));
+                }
+                _directories.emplace(std::move(current), std::move(record));
+            }
+        }
+
+        // the rest of every subtree on the workers, each into its own map
+        struct subtree_scan {
+            directory_map directories;
+            std::future<size_t> listed_count;
+        };
+        std::vector<subtree_scan> scans(frontier.size());
+        for (size_t indx = 0; indx < frontier.size(); ++indx) {
+            subtree_scan &scan = scans[indx];
+            scan.listed_count = workers.submit([this, &previous, &scan, rel = frontier[indx]] {
+                return walk_subtree(_root, rel, previous, scan.directories);
+            });
+        }
+        for (subtree_scan &scan: scans) {
+            _stats.listed_count += scan.listed_count.get();
+            _directories.merge(scan.directories);
+        }
+
+        // directories that went away are simply not reached
+        const bool changed = _stats.listed_count != 0 || _directories.size() != previous.size();
+
+        build_file_index();
+        _stats.directory_count = _directories.size();
+        _stats.file_count = _files.size();
+
+        if (changed && !_cache_file.empty()) {
+            _stats.saved = save();
+        }
+    }
+
+    std::optional<std::filesystem::path> ResourceIndex::find(std::string_view filename) const {
+        auto found = _files.find(filename);
+        if (found == _files.end()) {
+            return std::nullopt;
+        }
+        return _root / std::filesystem::path(found->second);
+    }
+
+    bool ResourceIndex::load(directory_map &directories) const {
+        std::ifstream in(_cache_file, std::ios::binary);
+        if (!in) {
+            return false;
+        }
+
+        std::string line;
+        if (!std::getline(in, line) || line != CACHE_HEADER) {
+            return false;
+        }
+        // an index of some other tree, X-Plane moved or the cache was copied
+        if (!std::getline(in, line) || line != _root.generic_string()) {
+            return false;
+        }
+
+        // D <tab> mtime <tab> path opens a directory, F and S lines list its files and subdirectories
+        directory_record *current = nullptr;
+        while (std::getline(in, line)) {
+            if (line.size() < 2 || line[1] != '\t') {
+                directories.clear();
+                return false;
+            }
+            std::string_view value = std::string_view(line).substr(2);
+
+            if (line[0] == 'D') {
+                size_t tab = value.find('\t');
+                directory_record record;
+                if (tab == std::string_view::npos ||
+                    std::from_chars(value.data(), value.data() + tab, record.mtime).ec != std::errc()) {
+                    directories.clear();
+                    return false;
+                }
+                current = &directories.insert_or_assign(std::string(value.substr(tab + 1)), std::move(record)).first->second;
+            } else if (current != nullptr && line[0] == 'F') {
+                current->files.emplace_back(value);
+            } else if (current != nullptr && line[0] == 'S') {
+                current->subdirectories.emplace_back(value);
+            } else {
+                directories.clear();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool ResourceIndex::save() const {
+        std::error_code ec;
+        std::filesystem::create_directories(_cache_file.parent_path(), ec);
+
+        // written aside and renamed over the old cache so a crash never leaves half an index
+        const std::filesystem::path temp_file = unique_temp_path(_cache_file);
+        {
+            std::ofstream out(temp_file, std::ios::binary | std::ios::trunc);
+            if (!out) {
+                return false;
+            }
+
+            out << CACHE_HEADER << '\n' << _root.generic_string() << '\n';
+            for (const auto &[rel, record]: _directories) {
+                out << "D\t" << record.mtime << '\t' << rel << '\n';
+                for (const std::string &file: record.files) {
+                    out << "F\t" << file << '\n';
+                }
+                for (const std::string &subdirectory: record.subdirectories) {
+                    out << "S\t" << subdirectory << '\n';
+                }
+            }
+            if (!out) {
+                out.close();
+                std::filesystem::remove(temp_file, ec);
+                return false;
+            }
+        }
+
+        std::filesystem::rename(temp_file, _cache_file, ec);
+        if (ec) {
+            std::filesystem::remove(temp_file, ec);
+            return false;
+        }
+        return true;
+    }
+
+    void ResourceIndex::build_file_index() {
+        _files.clear();
+        for (const auto &[rel, record]: _directories) {
+            for (const std::string &file: record.files) {
+                std::string path = child_path(rel, file);
+                auto [it, inserted] = _files.try_emplace(file, path);
+                // the map order is arbitrary, keep the shallowest then lowest path so lookups are repeatable
+                if (!inserted && path_order(path) < path_order(it->second)) {
+                    it->second = std::move(path);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,77 @@
+//
+// Created by icarr on 17/10/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace gldraw {
+    /// Filename to path index of a directory tree, so resources are resolved by name without walking
+    /// the tree. The index is saved to a cache file and on the next load checked against the directory
+    /// modification times, only directories whose entries changed are listed again.
+    class ResourceIndex {
+    public:
+        struct statistics {
+            size_t directory_count{};
+            size_t file_count{};
+            /// directories listed by the last refresh, the rest were reused from the cache
+            size_t listed_count{};
+            /// false when the cache file could not be written
+            bool saved{true};
+        };
+
+    public:
+        /// @param cache_file where the index persists between loads, empty to keep it in memory only
+        explicit ResourceIndex(std::filesystem::path root, std::filesystem::path cache_file = {});
+
+        /// load the cache if it is for this root, bring it up to date with the tree and save it if anything changed
+        /// @param thread_count threads scanning the tree, 0 for one less than the hardware threads
+        void refresh(unsigned int thread_count = 0);
+
+        /// the file called filename, the first in path order when there are several
+        [[nodiscard]] std::optional<std::filesystem::path> find(std::string_view filename) const;
+
+        [[nodiscard]] const std::filesystem::path &get_root() const { return _root; }
+
+        [[nodiscard]] statistics get_statistics() const { return _stats; }
+
+    public:
+        /// the entries of one directory, listed or loaded from the cache
+        struct directory_record {
+            int64_t mtime{};
+            std::vector<std::string> files;
+            std::vector<std::string> subdirectories;
+        };
+
+        /// keyed by the generic path relative to the root, "" for the root itself
+        using directory_map = std::unordered_map<std::string, directory_record>;
+
+    private:
+        bool load(directory_map &directories) const;
+        bool save() const;
+        void build_file_index();
+
+    private:
+        // lets the file index be queried with a string_view
+        struct string_hash {
+            using is_transparent = void;
+            size_t operator()(std::string_view str) const { return std::hash<std::string_view>{}(str); }
+        };
+
+        std::filesystem::path _root;
+        std::filesystem::path _cache_file;
+
+        directory_map _directories;
+        // filename to its generic path relative to the root
+        std::unordered_map<std::string, std::string, string_hash, std::equal_to<>> _files;
+
+        statistics _stats;
+    };
+}
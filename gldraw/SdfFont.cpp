@@ -0,0 +1,120 @@
+//
+// Created by icarr on 17/10/2026.
+//
+
+#include <format>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <stdexcept>
+
+#include <stb/stb_truetype.h>
+
+#include "SdfFont.h"
+
+namespace gldraw {
+    namespace {
+        // distance field value on the outline, the shader's 0.5
+        constexpr unsigned char SDF_ON_EDGE = 128;
+    }
+
+    struct SdfFont::font_info {
+        stbtt_fontinfo info{};
+    };
+
+    SdfFont::SdfFont(const std::filesystem::path &ttf_filename, float sdf_pixel_height, int spread, int page_size) :
+            _font(std::make_unique<font_info>()),
+            _sdf_pixel_height(sdf_pixel_height),
+            _spread(spread),
+            // text draws with a single page bound
+            _atlas(page_size, 1, 1) {
+        std::ifstream in(ttf_filename, std::ios::binary);
+        if (!in) {
+            throw std::runtime_error(std::format("Failed to open font {}", ttf_filename.string()));
+        }
+        _ttf_data.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+
+        // stb_truetype keeps pointers into the data, it lives as long as the font
+        const int offset = stbtt_GetFontOffsetForIndex(_ttf_data.data(), 0);
+        if (offset < 0 || !stbtt_InitFont(&_font->info, _ttf_data.data(), offset)) {
+            throw std::runtime_error(std::format("Failed to read font {}", ttf_filename.string()));
+        }
+
+        _scale = stbtt_ScaleForPixelHeight(&_font->info, sdf_pixel_height);
+        int ascent, descent, line_gap;
+        stbtt_GetFontVMetrics(&_font->info, &ascent, &descent, &line_gap);
+        _ascent = ascent * _scale;
+        _descent = descent * _scale;
+        _line_gap = line_gap * _scale;
+
+        // the numbers and labels of most pages, generated up front rather than while drawing
+        for (char32_t codepoint = U' '; codepoint <= U'~'; ++codepoint) {
+            generate_glyph(codepoint);
+        }
+    }
+
+    SdfFont::~SdfFont() = default;
+
+    const glyph_metrics *SdfFont::find_glyph(char32_t codepoint) {
+        auto found = _glyphs.find(codepoint);
+        if (found != _glyphs.end()) {
+            return &found->second;
+        }
+        if (_missing.contains(codepoint)) {
+            return nullptr;
+        }
+        return generate_glyph(codepoint);
+    }
+
+    float SdfFont::get_kerning(const glyph_metrics &first, const glyph_metrics &second) const {
+        return stbtt_GetGlyphKernAdvance(&_font->info, first.glyph_index, second.glyph_index) * _scale;
+    }
+
+    const glyph_metrics *SdfFont::generate_glyph(char32_t codepoint) {
+        const int glyph_index = stbtt_FindGlyphIndex(&_font->info, static_cast<int>(codepoint));
+        if (glyph_index == 0 && codepoint != U' ') {
+            _missing.insert(codepoint);
+            return nullptr;
+        }
+
+        glyph_metrics glyph;
+        glyph.glyph_index = glyph_index;
+        int advance, left_bearing;
+        stbtt_GetGlyphHMetrics(&_font->info, glyph_index, &advance, &left_bearing);
+        glyph.advance = advance * _scale;
+
+        int width = 0, height = 0, x_offset = 0, y_offset = 0;
+        unsigned char *sdf = stbtt_GetGlyphSDF(&_font->info, _scale, glyph_index, _spread, SDF_ON_EDGE,
+                                               static_cast<float>(SDF_ON_EDGE) / _spread,
+                                               &width, &height, &x_offset, &y_offset);
+        if (sdf != nullptr) {
+            // white with the distance in alpha, flipped to bottom up rows
+            _rgba.resize(static_cast<size_t>(width) * height * 4);
+            for (int y = 0; y < height; ++y) {
+                const unsigned char *src = sdf + static_cast<size_t>(height - 1 - y) * width;
+                unsigned char *dst = _rgba.data() + static_cast<size_t>(y) * width * 4;
+                for (int x = 0; x < width; ++x) {
+                    dst[4 * x] = dst[4 * x + 1] = dst[4 * x + 2] = 0xFF;
+                    dst[4 * x + 3] = src[x];
+                }
+            }
+            stbtt_FreeSDF(sdf, nullptr);
+
+            std::optional<atlas_region> region = _atlas.try_add_image(_rgba.data(), width, height);
+            if (!region) {
+                // the page is full, a font needing more wants a larger page_size
+                _missing.insert(codepoint);
+                return nullptr;
+            }
+            glyph.region = *region;
+
+            // stb_truetype measures down from the baseline to the top of the bitmap
+            glyph.x_offset = static_cast<float>(x_offset);
+            glyph.y_offset = static_cast<float>(-(y_offset + height));
+            glyph.width = static_cast<float>(width);
+            glyph.height = static_cast<float>(height);
+        }
+
+        return &_glyphs.emplace(codepoint, glyph).first->second;
+    }
+}
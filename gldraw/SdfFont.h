@@ -0,0 +1,85 @@
+//
+// Created by icarr on 17/10/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <glad/gl.h>
+
+#include <gldraw/TextureAtlas.h>
+
+namespace gldraw {
+    /// placement of one glyph, in pixels at the font's sdf_pixel_height with y up from the baseline
+    struct glyph_metrics {
+        atlas_region region;
+        // bottom left of the glyph's quad relative to the pen position
+        float x_offset{};
+        float y_offset{};
+        float width{};
+        float height{};
+        // pen movement to the next glyph
+        float advance{};
+        // the font's glyph index, for kerning
+        int glyph_index{};
+    };
+
+    /// A TrueType font rendered to signed distance field glyphs in a TextureAtlas page. The distance is in
+    /// the alpha channel, 0.5 on the outline, so glyphs drawn with shader_variant::sdf stay sharp at any
+    /// size. Printable ASCII is generated at load, other characters the first time they are asked for.
+    class SdfFont {
+    public:
+        /// @param sdf_pixel_height the size glyphs are rendered at in the atlas
+        /// @param spread pixels of distance either side of the outline, also the padding around each glyph
+        /// @throws std::runtime_error if the font cannot be read
+        explicit SdfFont(const std::filesystem::path &ttf_filename, float sdf_pixel_height = 32.0f,
+                         int spread = 4, int page_size = 1024);
+        ~SdfFont();
+
+        SdfFont(const SdfFont &other) = delete;
+        SdfFont &operator=(const SdfFont &other) = delete;
+
+    public:
+        /// the glyph for codepoint, generated on first use, nullptr when the font has no such character
+        const glyph_metrics *find_glyph(char32_t codepoint);
+
+        /// extra pen movement between two glyphs, in pixels at sdf_pixel_height
+        [[nodiscard]] float get_kerning(const glyph_metrics &first, const glyph_metrics &second) const;
+
+        [[nodiscard]] float get_sdf_pixel_height() const { return _sdf_pixel_height; }
+        [[nodiscard]] float get_ascent() const { return _ascent; }
+        [[nodiscard]] float get_descent() const { return _descent; }
+        [[nodiscard]] float get_line_height() const { return _ascent - _descent + _line_gap; }
+
+        /// the atlas page holding every glyph, bind it to draw text in this font
+        [[nodiscard]] GLuint get_texture() const { return _atlas.get_page_count() > 0 ? _atlas.get_page_texture(0) : 0; }
+
+    private:
+        const glyph_metrics *generate_glyph(char32_t codepoint);
+
+    private:
+        // stbtt_fontinfo, kept out of this header
+        struct font_info;
+        std::unique_ptr<font_info> _font;
+        std::vector<unsigned char> _ttf_data;
+
+        float _sdf_pixel_height;
+        float _scale{};
+        int _spread;
+        float _ascent{};
+        float _descent{};
+        float _line_gap{};
+
+        TextureAtlas _atlas;
+        std::unordered_map<char32_t, glyph_metrics> _glyphs;
+        // characters the font lacks or that did not fit the first page, so they are not retried
+        std::unordered_set<char32_t> _missing;
+        std::vector<unsigned char> _rgba;
+    };
+}
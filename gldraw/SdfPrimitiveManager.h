@@ -0,0 +1,133 @@
+//
+// Created by icarr on 17/10/2026.
+//
+
+#pragma once
+
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+#include <glad/gl.h>
+
+#include <gldraw/geom.h>
+#include <gldraw/colour.h>
+#include <gldraw/vertex_layout.h>
+#include <gldraw/shaders/sdf_primitive.h>
+#include <glmath/vectors.h>
+
+namespace gldraw {
+    /// circles, rings, arcs, capsules and rounded rects stored as one sdf_primitive_instance each and
+    /// drawn with a single glDrawArraysInstanced, use with get_sdf_primitive_shader. Each primitive is
+    /// one quad however large, angles are radians counter clockwise from +x.
+    class SdfPrimitiveManager {
+    public:
+        SdfPrimitiveManager() {
+            // created rather than generated so the DSA calls below have objects to work on
+            glCreateVertexArrays(1, &_VAO);
+            glCreateBuffers(1, &_VBO);
+
+            // the attribute formats never change, reallocating the buffer keeps its name attached
+            configure_instance_array<sdf_primitive_instance>(_VAO);
+            bind_vertex_buffer<sdf_primitive_instance>(_VAO, _VBO);
+        }
+
+        ~SdfPrimitiveManager() {
+            glDeleteVertexArrays(1, &_VAO);
+            glDeleteBuffers(1, &_VBO);
+        }
+
+        SdfPrimitiveManager(const SdfPrimitiveManager &other) = delete;
+        SdfPrimitiveManager &operator=(const SdfPrimitiveManager &other) = delete;
+
+    public:
+        [[nodiscard]] unsigned int get_instance_count() const {
+            return _instances.size();
+        }
+
+    public:
+        void clear() {
+            _instances.clear();
+        }
+
+        /// @return the index of the new instance for update_primitive, as for every add_
+        size_t add_circle(glmath::vec2f centre, float radius, const gldraw::colour &colour = gldraw::COL_WHITE) {
+            return add({sdf_shape::circle, centre, {radius, radius}, radius, 0.0f, 0.0f, 0.0f, colour});
+        }
+
+        /// a circle outline, radius to the middle of the line
+        size_t add_ring(glmath::vec2f centre, float radius, float thickness, const gldraw::colour &colour = gldraw::COL_WHITE) {
+            const float extent = radius + thickness / 2.0f;
+            return add({sdf_shape::ring, centre, {extent, extent}, radius, thickness, 0.0f, 0.0f, colour});
+        }
+
+        /// part of a circle outline with round ends, radius to the middle of the line
+        size_t add_arc(glmath::vec2f centre, float radius, float thickness, float start_angle, float end_angle,
+                       const gldraw::colour &colour = gldraw::COL_WHITE) {
+            const float extent = radius + thickness / 2.0f;
+            return add({sdf_shape::arc, centre, {extent, extent}, radius, thickness, start_angle, end_angle - start_angle, colour});
+        }
+
+        /// a line from start to end with round ends, radius is half its width
+        size_t add_capsule(glmath::vec2f start, glmath::vec2f end, float radius, const gldraw::colour &colour = gldraw::COL_WHITE) {
+            const glmath::vec2f along = end - start;
+            const float half_length = along.magnitude() / 2.0f;
+            return add({sdf_shape::capsule, (start + end) * 0.5f, {half_length + radius, radius},
+                        half_length, radius, 0.0f, 0.0f, colour, std::atan2(along.y, along.x)});
+        }
+
+        /// @param outline thickness of the outline inside rct, 0 to fill it
+        /// @param rotation radians counter clockwise about the centre of rct
+        size_t add_rounded_rect(const gldraw::rect &rct, float corner_radius, const gldraw::colour &colour = gldraw::COL_WHITE,
+                                float outline = 0.0f, float rotation = 0.0f) {
+            const glmath::vec2f half_size = rct.size * 0.5f;
+            const float radius = std::fmin(corner_radius, std::fmin(half_size.x, half_size.y));
+            return add({sdf_shape::rounded_rect, rct.pos + half_size, half_size,
+                        half_size.x, half_size.y, radius, outline, colour, rotation});
+        }
+
+        void update_primitive(size_t index, const sdf_primitive_instance &instance) {
+            assert(index < _instances.size());
+            _instances[index] = instance;
+        }
+
+        [[nodiscard]] const sdf_primitive_instance &get_primitive(size_t index) const {
+            assert(index < _instances.size());
+            return _instances[index];
+        }
+
+    public:
+        void gen_buffers() {
+            size_t inst_buf_size = _instances.size() * sizeof(sdf_primitive_instance);
+
+            // do we re-use the buffer or generate a new larger one?
+            if (_instances.size() <= _inst_buf_size && _inst_buf_size != 0) {
+                glNamedBufferSubData(_VBO, 0, inst_buf_size, _instances.data());
+            } else {
+                glNamedBufferData(_VBO, inst_buf_size, _instances.data(), GL_STREAM_DRAW);
+                _inst_buf_size = _instances.size();
+            }
+        }
+
+        /// draw the current content, the VAO is left bound
+        void draw() {
+            glBindVertexArray(_VAO);
+            glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, get_instance_count());
+        }
+
+        [[nodiscard]] unsigned int get_vbo() const { return _VBO; }
+        [[nodiscard]] unsigned int get_vao() const { return _VAO; }
+
+    private:
+        size_t add(const sdf_primitive_instance &instance) {
+            _instances.push_back(instance);
+            return _instances.size() - 1;
+        }
+
+    private:
+        unsigned int _VBO{}, _VAO{};
+        std::vector<sdf_primitive_instance> _instances;
+
+        size_t _inst_buf_size{};
+    };
+}
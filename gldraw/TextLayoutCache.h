@@ -0,0 +1,201 @@
+//
+// Created by icarr on 17/10/2026.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <gldraw/BufferValidator.h>
+#include <gldraw/SdfFont.h>
+#include <gldraw/VertexManager.h>
+#include <gldraw/colour.h>
+#include <gldraw/geom.h>
+#include <glmath/vectors.h>
+
+namespace gldraw {
+    /// a string laid out in one font and size, quads relative to the start of the first baseline
+    struct text_layout {
+        std::vector<gldraw::rect> rects;
+        std::vector<gldraw::rect> uvs;
+        // widest line
+        float width{};
+        // first baseline to last, 0 for a single line
+        float depth{};
+    };
+
+    /// Lays out UTF-8 strings in an SdfFont and remembers the result, keyed by string, font and size, so
+    /// text repeated every frame such as tape labels is laid out once. add_text emits a whole string's
+    /// glyph quads into a VertexManager in one add_quads. Layout applies the font's kerning, '\n' starts a
+    /// new line and characters the font lacks show as '?'.
+    class TextLayoutCache {
+    public:
+        /// @param capacity layouts kept, the least recently used is dropped beyond this
+        explicit TextLayoutCache(size_t capacity = 512) : _capacity(std::max<size_t>(capacity, 1)) {}
+
+        TextLayoutCache(const TextLayoutCache &other) = delete;
+        TextLayoutCache &operator=(const TextLayoutCache &other) = delete;
+
+        struct statistics {
+            size_t hits{};
+            size_t misses{};
+            size_t entries{};
+        };
+
+    public:
+        /// the layout of text in font at pixel_size, valid until the next call
+        const text_layout &layout(SdfFont &font, std::string_view text, float pixel_size) {
+            const SdfFont *p_font = &font;
+            const uint64_t hash = hash_bytes(text.data(), text.size(),
+                                             hash_bytes(&pixel_size, sizeof(pixel_size),
+                                                        hash_bytes(&p_font, sizeof(p_font))));
+            auto [first, last] = _index.equal_range(hash);
+            for (auto found = first; found != last; ++found) {
+                entry &ent = *found->second;
+                if (ent.font == &font && ent.pixel_size == pixel_size && ent.text == text) {
+                    // most recently used first
+                    _entries.splice(_entries.begin(), _entries, found->second);
+                    ++_hits;
+                    return ent.layout;
+                }
+            }
+            ++_misses;
+
+            if (_entries.size() >= _capacity) {
+                remove_from_index(_entries.back());
+                _entries.pop_back();
+            }
+
+            entry &ent = _entries.emplace_front();
+            ent.hash = hash;
+            ent.font = &font;
+            ent.pixel_size = pixel_size;
+            ent.text = text;
+            lay_out(font, text, pixel_size, ent.layout);
+            _index.emplace(hash, _entries.begin());
+            return ent.layout;
+        }
+
+        /// Append the glyph quads of text with its first baseline starting at origin, draw them with
+        /// shader_variant::sdf and font.get_texture() bound.
+        /// @return the layout, for measuring the text
+        template<vertex_layout TVertex>
+        const text_layout &add_text(VertexManager<TVertex> &manager, SdfFont &font, std::string_view text,
+                                    glmath::vec2f origin, float pixel_size, const gldraw::colour &colour = gldraw::COL_WHITE) {
+            const text_layout &laid_out = layout(font, text, pixel_size);
+
+            _rects.resize(laid_out.rects.size());
+            std::transform(laid_out.rects.begin(), laid_out.rects.end(), _rects.begin(), [origin](gldraw::rect rct) {
+                rct.pos = rct.pos + origin;
+                return rct;
+            });
+            _colours.assign(laid_out.rects.size(), colour);
+
+            manager.add_quads(_rects, _colours, laid_out.uvs);
+            return laid_out;
+        }
+
+        [[nodiscard]] statistics get_statistics() const { return {_hits, _misses, _entries.size()}; }
+
+        void clear() {
+            _entries.clear();
+            _index.clear();
+        }
+
+    private:
+        struct entry {
+            uint64_t hash{};
+            const SdfFont *font{};
+            float pixel_size{};
+            std::string text;
+            text_layout layout;
+        };
+
+        /// next codepoint of UTF-8 text from pos, U+FFFD for a malformed sequence
+        static char32_t decode_utf8(std::string_view text, size_t &pos) {
+            const auto lead = static_cast<unsigned char>(text[pos++]);
+            if (lead < 0x80) {
+                return lead;
+            }
+
+            int continuation = lead >= 0xF0 ? 3 : lead >= 0xE0 ? 2 : lead >= 0xC0 ? 1 : -1;
+            if (continuation < 0 || pos + continuation > text.size()) {
+                return U'\uFFFD';
+            }
+            char32_t codepoint = lead & (0x3F >> continuation);
+            for (; continuation > 0; --continuation) {
+                const auto next = static_cast<unsigned char>(text[pos]);
+                if ((next & 0xC0) != 0x80) {
+                    return U'\uFFFD';
+                }
+                codepoint = (codepoint << 6) | (next & 0x3F);
+                ++pos;
+            }
+            return codepoint;
+        }
+
+        static void lay_out(SdfFont &font, std::string_view text, float pixel_size, text_layout &laid_out) {
+            const float scale = pixel_size / font.get_sdf_pixel_height();
+            float pen_x = 0.0f, baseline = 0.0f;
+            const glyph_metrics *previous = nullptr;
+
+            for (size_t pos = 0; pos < text.size();) {
+                const char32_t codepoint = decode_utf8(text, pos);
+                if (codepoint == U'\n') {
+                    pen_x = 0.0f;
+                    baseline -= font.get_line_height() * scale;
+                    previous = nullptr;
+                    continue;
+                }
+
+                const glyph_metrics *glyph = font.find_glyph(codepoint);
+                if (glyph == nullptr && (glyph = font.find_glyph(U'?')) == nullptr) {
+                    continue;
+                }
+
+                if (previous != nullptr) {
+                    pen_x += font.get_kerning(*previous, *glyph) * scale;
+                }
+                // spaces have no quad, only an advance
+                if (glyph->width > 0.0f) {
+                    laid_out.rects.push_back({{pen_x + glyph->x_offset * scale, baseline + glyph->y_offset * scale},
+                                              {glyph->width * scale, glyph->height * scale}});
+                    laid_out.uvs.push_back(glyph->region.uv);
+                }
+                pen_x += glyph->advance * scale;
+                laid_out.width = std::max(laid_out.width, pen_x);
+                previous = glyph;
+            }
+            laid_out.depth = -baseline;
+        }
+
+        void remove_from_index(const entry &ent) {
+            auto [first, last] = _index.equal_range(ent.hash);
+            for (auto found = first; found != last; ++found) {
+                if (&*found->second == &ent) {
+                    _index.erase(found);
+                    return;
+                }
+            }
+        }
+
+    private:
+        size_t _capacity;
+        // most recently used first
+        std::list<entry> _entries;
+        std::unordered_multimap<uint64_t, std::list<entry>::iterator> _index;
+
+        size_t _hits{};
+        size_t _misses{};
+
+        // add_text staging, kept to avoid allocating per string
+        std::vector<gldraw::rect> _rects;
+        std::vector<gldraw::colour> _colours;
+    };
+}
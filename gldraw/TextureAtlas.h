@@ -0,0 +1,164 @@
+//
+// Created by icarr on 17/10/2026.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <format>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <glad/gl.h>
+
+#include <gldraw/geom.h>
+#include <gldraw/skyline_packer.h>
+#include <gldraw/texture_cache.h>
+
+namespace gldraw {
+    /// where an image landed in a TextureAtlas, pass to VertexManager::add_quad for its uvs
+    struct atlas_region {
+        uint32_t page{};
+        /// the image in normalised atlas page coordinates
+        gldraw::rect uv{};
+        int width{};
+        int height{};
+
+        /// map a uv rect within the image, 0..1 over the image, to atlas page coordinates
+        [[nodiscard]] gldraw::rect map(const gldraw::rect &image_uv) const {
+            return {{uv.pos.x + image_uv.pos.x * uv.size.x, uv.pos.y + image_uv.pos.y * uv.size.y},
+                    {image_uv.size.x * uv.size.x, image_uv.size.y * uv.size.y}};
+        }
+    };
+
+    /// Packs many small RGBA8 images into large pages so quads using any of them draw together, one
+    /// draw per page. Images are placed by a skyline_packer with their edge texels repeated around them,
+    /// so linear filtering never picks up a neighbour.
+    class TextureAtlas {
+    public:
+        /// @param padding texels of repeated edge around each image
+        /// @param max_pages pages the atlas may grow to, 0 for no limit
+        explicit TextureAtlas(int page_size = 2048, int padding = 1, uint32_t max_pages = 0) :
+                _page_size(page_size), _padding(padding), _max_pages(max_pages) {}
+
+        ~TextureAtlas() {
+            for (page &pg: _pages) {
+                glDeleteTextures(1, &pg.texture);
+            }
+        }
+
+        TextureAtlas(const TextureAtlas &other) = delete;
+        TextureAtlas &operator=(const TextureAtlas &other) = delete;
+
+    public:
+        /// copy a width x height RGBA8 image, rows bottom up, into the atlas
+        /// @throws std::runtime_error if the image is larger than a page or max_pages are full
+        atlas_region add_image(const unsigned char *rgba, int width, int height) {
+            std::optional<atlas_region> region = try_add_image(rgba, width, height);
+            if (!region) {
+                throw std::runtime_error(std::format("Image {}x{} does not fit a {} atlas page", width, height, _page_size));
+            }
+            return *region;
+        }
+
+        /// as add_image, but nothing when the image is larger than a page or max_pages are full
+        std::optional<atlas_region> try_add_image(const unsigned char *rgba, int width, int height) {
+            const int padded_width = width + 2 * _padding, padded_height = height + 2 * _padding;
+            if (padded_width > _page_size || padded_height > _page_size) {
+                return std::nullopt;
+            }
+
+            // try the existing pages before starting another
+            std::optional<texel_rect> placed;
+            uint32_t page_indx = 0;
+            for (; page_indx < _pages.size() && !placed; ++page_indx) {
+                placed = _pages[page_indx].packer.insert(padded_width, padded_height);
+            }
+            if (placed) {
+                --page_indx;
+            } else {
+                if (_max_pages != 0 && _pages.size() >= _max_pages) {
+                    return std::nullopt;
+                }
+                page_indx = add_page();
+                placed = _pages[page_indx].packer.insert(padded_width, padded_height);
+            }
+
+            upload_padded(_pages[page_indx].texture, *placed, rgba, width, height);
+
+            const float texel = 1.0f / static_cast<float>(_page_size);
+            atlas_region region;
+            region.page = page_indx;
+            region.uv = {{static_cast<float>(placed->x + _padding) * texel, static_cast<float>(placed->y + _padding) * texel},
+                         {static_cast<float>(width) * texel, static_cast<float>(height) * texel}};
+            region.width = width;
+            region.height = height;
+            return region;
+        }
+
+        /// load an image file, through its texture cache, into the atlas
+        /// @throws std::runtime_error if it cannot be loaded or is larger than a page
+        atlas_region add_image_file(const std::string &image_filename) {
+            texture_image image = load_texture_image(image_filename);
+            if (image.levels.empty()) {
+                throw std::runtime_error(std::format("Failed to load atlas image {}: {}", image_filename, image.error));
+            }
+            return add_image(image.levels[0].data, image.width, image.height);
+        }
+
+        [[nodiscard]] uint32_t get_page_count() const { return _pages.size(); }
+
+        /// the texture of a page, bind it to draw the quads using its regions
+        [[nodiscard]] GLuint get_page_texture(uint32_t page) const { return _pages[page].texture; }
+
+        [[nodiscard]] float get_page_occupancy(uint32_t page) const { return _pages[page].packer.get_occupancy(); }
+
+    private:
+        struct page {
+            GLuint texture{};
+            skyline_packer packer;
+        };
+
+        uint32_t add_page() {
+            page pg{0, skyline_packer(_page_size, _page_size)};
+            glCreateTextures(GL_TEXTURE_2D, 1, &pg.texture);
+            glTextureStorage2D(pg.texture, 1, GL_RGBA8, _page_size, _page_size);
+            glTextureParameteri(pg.texture, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTextureParameteri(pg.texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTextureParameteri(pg.texture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTextureParameteri(pg.texture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+            // unused space reads as transparent
+            const GLubyte transparent[4] = {0, 0, 0, 0};
+            glClearTexImage(pg.texture, 0, GL_RGBA, GL_UNSIGNED_BYTE, transparent);
+
+            _pages.push_back(std::move(pg));
+            return _pages.size() - 1;
+        }
+
+        /// upload the image with its edges repeated into the padding in one call
+        void upload_padded(GLuint texture, const texel_rect &placed, const unsigned char *rgba, int width, int height) {
+            _staging.resize(static_cast<size_t>(placed.width) * placed.height * 4);
+            for (int y = 0; y < placed.height; ++y) {
+                const int src_y = std::clamp(y - _padding, 0, height - 1);
+                for (int x = 0; x < placed.width; ++x) {
+                    const int src_x = std::clamp(x - _padding, 0, width - 1);
+                    std::copy_n(rgba + 4 * (static_cast<size_t>(src_y) * width + src_x), 4,
+                                _staging.data() + 4 * (static_cast<size_t>(y) * placed.width + x));
+                }
+            }
+
+            glTextureSubImage2D(texture, 0, placed.x, placed.y, placed.width, placed.height, GL_RGBA, GL_UNSIGNED_BYTE, _staging.data());
+        }
+
+    private:
+        int _page_size;
+        int _padding;
+        uint32_t _max_pages;
+        std::vector<page> _pages;
+        std::vector<unsigned char> _staging;
+    };
+}
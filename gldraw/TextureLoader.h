@@ -0,0 +1,199 @@
+//
+// Created by icarr on 17/10/2026.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <format>
+#include <future>
+#include <memory>
+#include <string>
+
+#include <glad/gl.h>
+
+#include <gldraw/texture_cache.h>
+#include <gldraw/textures.h>
+#include <gldraw/worker_pool.h>
+
+namespace gldraw {
+    /// a texture being loaded by TextureLoader, shows the white placeholder until the image is on the GPU
+    class texture_handle {
+    public:
+        texture_handle() = default;
+
+        /// the texture to bind this frame, GL thread only
+        [[nodiscard]] GLuint get() const {
+            return _state && _state->ready ? _state->texture : get_white_1x1_texture();
+        }
+
+        [[nodiscard]] bool is_ready() const { return _state && _state->ready; }
+
+        /// true once loading has finished or failed, a failed texture stays on the placeholder
+        [[nodiscard]] bool is_done() const { return _state && (_state->ready || _state->failed); }
+
+    private:
+        friend class TextureLoader;
+
+        struct state {
+            GLuint texture{};
+            bool ready{};
+            bool failed{};
+        };
+
+        std::shared_ptr<state> _state;
+    };
+
+    /// Loads textures without stalling the GL thread. Images are decoded, or mapped from their texture
+    /// cache, on a worker_pool. pump() then uploads every mip level through a pixel unpack buffer a slice
+    /// of rows at a time within a time budget.
+    class TextureLoader {
+    public:
+        /// @param slice_bytes the pixel unpack buffer size, the most uploaded per glTextureSubImage2D
+        explicit TextureLoader(worker_pool &workers, size_t slice_bytes = 1024 * 1024) :
+                _workers(workers), _slice_bytes(slice_bytes) {
+            glCreateBuffers(1, &_pbo);
+        }
+
+        ~TextureLoader() {
+            // decodes still running only write to their own futures
+            glDeleteBuffers(1, &_pbo);
+        }
+
+        TextureLoader(const TextureLoader &other) = delete;
+        TextureLoader &operator=(const TextureLoader &other) = delete;
+
+    public:
+        /// queue image_filename for loading, the handle shows the placeholder until pump() finishes it
+        texture_handle load(const std::string &image_filename) {
+            texture_handle handle;
+            handle._state = std::make_shared<texture_handle::state>();
+
+            pending_texture &pending = _pending.emplace_back();
+            pending.filename = image_filename;
+            pending.state = handle._state;
+            pending.decoded = _workers.submit([image_filename] {
+                return load_texture_image(image_filename);
+            });
+            return handle;
+        }
+
+        /// GL thread, once a frame: upload decoded images for up to budget_ms, at least one slice
+        void pump(double budget_ms = 1.0) {
+            const auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double, std::milli>(budget_ms);
+
+            bool first_slice = true;
+            while (!_pending.empty()) {
+                pending_texture &pending = _pending.front();
+
+                if (pending.texture == 0) {
+                    // images upload in the order they were asked for
+                    if (pending.decoded.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                        return;
+                    }
+                    pending.image = pending.decoded.get();
+                    if (pending.image.levels.empty()) {
+                        XPLMDebugString(std::format("Failed to load texture {}: {}\n", pending.filename, pending.image.error).c_str());
+                        pending.state->failed = true;
+                        _pending.pop_front();
+                        continue;
+                    }
+                    create_texture(pending);
+                }
+
+                if (!first_slice && std::chrono::steady_clock::now() >= deadline) {
+                    return;
+                }
+                first_slice = false;
+
+                if (upload_slice(pending)) {
+                    pending.state->texture = pending.texture;
+                    pending.state->ready = true;
+                    _pending.pop_front();
+                }
+            }
+        }
+
+        /// true when nothing is waiting to be decoded or uploaded
+        [[nodiscard]] bool is_idle() const { return _pending.empty(); }
+
+    private:
+        struct pending_texture {
+            std::string filename;
+            std::shared_ptr<texture_handle::state> state;
+            std::future<texture_image> decoded;
+            texture_image image;
+            GLuint texture{};
+            // the level and row upload_slice continues from
+            size_t next_level{};
+            int next_row{};
+        };
+
+        /// allocate storage for the full mip chain, filled by upload_slice
+        static void create_texture(pending_texture &pending) {
+            create_and_bind_texture(&pending.texture);
+
+            // the same parameters as create_clamped_texture_from_image_file
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+            GLfloat max_aniso = 0.0f;
+            glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY, &max_aniso);
+            glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY, max_aniso);
+
+            glTexStorage2D(GL_TEXTURE_2D, pending.image.levels.size(), GL_RGBA8, pending.image.width, pending.image.height);
+        }
+
+        /// copy the next rows through the unpack buffer into the texture
+        /// @return true once the last row of the last level is uploaded
+        bool upload_slice(pending_texture &pending) {
+            const texture_level &level = pending.image.levels[pending.next_level];
+            const size_t row_bytes = static_cast<size_t>(level.width) * 4;
+            const int rows = std::min(level.height - pending.next_row, static_cast<int>(std::max<size_t>(1, _slice_bytes / row_bytes)));
+            const size_t slice_size = rows * row_bytes;
+
+            // orphan the previous slice rather than wait for the GPU to finish reading it
+            if (slice_size > _pbo_size) {
+                _pbo_size = std::max(slice_size, _slice_bytes);
+            }
+            glNamedBufferData(_pbo, _pbo_size, nullptr, GL_STREAM_DRAW);
+            void *p_data = glMapNamedBufferRange(_pbo, 0, slice_size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+            if (p_data == nullptr) {
+                return false;
+            }
+            std::memcpy(p_data, level.data + pending.next_row * row_bytes, slice_size);
+            glUnmapNamedBuffer(_pbo);
+
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _pbo);
+            glTextureSubImage2D(pending.texture, pending.next_level, 0, pending.next_row, level.width, rows, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+            pending.next_row += rows;
+            if (pending.next_row < level.height) {
+                return false;
+            }
+            pending.next_row = 0;
+            if (++pending.next_level < pending.image.levels.size()) {
+                return false;
+            }
+
+            // the decoded pixels or cache mapping are no longer needed
+            pending.image = {};
+            return true;
+        }
+
+    private:
+        worker_pool &_workers;
+        size_t _slice_bytes;
+
+        GLuint _pbo{};
+        size_t _pbo_size{};
+
+        std::deque<pending_texture> _pending;
+    };
+}
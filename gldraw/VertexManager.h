@@ -4,13 +4,28 @@
 
 #pragma once
 
-#include <functional>
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string>
+#include <type_traits>
 #include <vector>
 #include <memory>
+#include <memory_resource>
+#include <cstring>
 
 #include <glad/gl.h>
 
+#include <gldraw/BufferValidator.h>
+#include <gldraw/dirty_range.h>
+#include <gldraw/frame_arena.h>
 #include <gldraw/geom.h>
+#include <gldraw/quad_indices.h>
+#include <gldraw/TextureAtlas.h>
+#include <gldraw/vertex_layout.h>
+#include <gldraw/shaders/shader_variant.h>
 #include <gldraw/colour.h>
 #include <glmath/vectors.h>
 #include <glmath/matrices.h>
@@ -18,18 +33,82 @@
 #define ZINK_BUFFER_CORRUPTION_BUG
 
 namespace gldraw {
-    template<typename TVertex>
+    /// how the vertex manager moves its geometry to the GPU
+    enum class buffer_usage {
+        /// geometry staged in vectors, glBufferSubData into the existing buffers, glBufferData when they grow
+        stream,
+        /// geometry staged in vectors, glBufferData (GL_STATIC_DRAW) on every gen_buffers
+        static_draw,
+        /// geometry written straight into a persistently mapped buffer split into fenced frame regions
+        persistent_ring
+    };
+
+    /// default vertex callback for add_quad(s), compiles away
+    struct no_vertex_callback {
+        template<typename TVertex>
+        void operator()(TVertex &) const {}
+    };
+
+    /// stable reference to a quad added with VertexManager::add_quad, survives compaction but not clear()
+    struct quad_handle {
+        static constexpr uint32_t INVALID_SLOT = std::numeric_limits<uint32_t>::max();
+
+        uint32_t slot{INVALID_SLOT};
+        uint32_t generation{};
+
+        [[nodiscard]] bool is_null() const { return slot == INVALID_SLOT; }
+    };
+
+    template<vertex_layout TVertex>
     class VertexManager {
     public:
         using vertex_type = TVertex;
     public:
-        VertexManager(bool static_buffers = false) : _static_buffers(static_buffers) {
-            glGenVertexArrays(1, &_VAO);
-            glGenBuffers(1, &_VBO);
-            glGenBuffers(1, &_EBO);
+        VertexManager(bool static_buffers = false) :
+                VertexManager(static_buffers ? buffer_usage::static_draw : buffer_usage::stream) {}
+
+        /// @param ring_vertex_capacity initial vertex capacity of each ring region (persistent_ring only)
+        /// @param ring_regions number of frame regions in the ring, must cover the draws in flight (persistent_ring only)
+        explicit VertexManager(buffer_usage usage, unsigned int ring_vertex_capacity = 1024, unsigned int ring_regions = 3) :
+                _usage(usage) {
+            // created rather than generated so the DSA calls below have objects to work on
+            glCreateVertexArrays(1, &_VAO);
+            glCreateBuffers(1, &_VBO);
+            glCreateBuffers(1, &_EBO);
+
+            // the attribute formats never change, only the buffer behind them
+            configure_vertex_array<TVertex>(_VAO);
+            bind_vertex_buffer<TVertex>(_VAO, _VBO);
+
+            if (_usage == buffer_usage::persistent_ring) {
+                _ring_fences.resize(std::max(ring_regions, 1u), nullptr);
+                // a quad is 4 vertices and 6 indices, size the index region to match
+                allocate_ring(ring_vertex_capacity, ring_vertex_capacity / 2 * 3);
+            }
+        }
+
+        /// stage the geometry in arena, for managers rebuilt every frame. clear() must be called after
+        /// each arena reset before anything is added
+        VertexManager(buffer_usage usage, frame_arena &arena) :
+                VertexManager(usage) {
+            // persistent_ring managers have no staging
+            assert(usage != buffer_usage::persistent_ring);
+
+            _arena = &arena;
+            _arena_generation = arena.generation();
+            // the vectors are still empty, rebuild them on the arena
+            std::destroy_at(&_vertices);
+            std::construct_at(&_vertices, &arena);
+            std::destroy_at(&_indices);
+            std::construct_at(&_indices, &arena);
         }
 
         ~VertexManager() {
+            for (GLsync fence: _ring_fences) {
+                if (fence != nullptr) {
+                    glDeleteSync(fence);
+                }
+            }
             glDeleteVertexArrays(1, &_VAO);
             glDeleteBuffers(1, &_VBO);
             glDeleteBuffers(1, &_EBO);
@@ -48,8 +127,40 @@ namespace gldraw {
                 _EBO = other._EBO;
                 other._EBO = 0;
 
-                _vertices = std::move(other._vertices);
-                _indices = std::move(other._indices);
+                _usage = other._usage;
+                _shader_variant = other._shader_variant;
+                // move construct so the storage and its memory resource travel together
+                std::destroy_at(&_vertices);
+                std::construct_at(&_vertices, std::move(other._vertices));
+                std::destroy_at(&_indices);
+                std::construct_at(&_indices, std::move(other._indices));
+                _vert_buf_size = other._vert_buf_size;
+                _ind_buf_size = other._ind_buf_size;
+                _vert_dirty = std::move(other._vert_dirty);
+                _ind_dirty = std::move(other._ind_dirty);
+                _uploaded_vert_count = other._uploaded_vert_count;
+                _uploaded_ind_count = other._uploaded_ind_count;
+                _quads_only = other._quads_only;
+                _bound_ebo = other._bound_ebo;
+                _bound_ebo_generation = other._bound_ebo_generation;
+                _quad_slots = std::move(other._quad_slots);
+                _free_slots = std::move(other._free_slots);
+                _quad_owners = std::move(other._quad_owners);
+                _free_quad_count = other._free_quad_count;
+                _next_generation = other._next_generation;
+                _arena = other._arena;
+                _arena_generation = other._arena_generation;
+
+                _ring_fences = std::move(other._ring_fences);
+                _ring_region = other._ring_region;
+                _ring_vert_capacity = other._ring_vert_capacity;
+                _ring_ind_capacity = other._ring_ind_capacity;
+                _ring_vert_count = other._ring_vert_count;
+                _ring_ind_count = other._ring_ind_count;
+                _ring_vertices = other._ring_vertices;
+                other._ring_vertices = nullptr;
+                _ring_indices = other._ring_indices;
+                other._ring_indices = nullptr;
             }
             return *this;
         }
@@ -59,143 +170,738 @@ namespace gldraw {
         };
 
     public:
+        unsigned int get_vertex_count() const {
+            if (_usage == buffer_usage::persistent_ring) {
+                return _ring_vert_count;
+            }
+            return _vertices.size();
+        }
+
         unsigned int get_element_count() const {
+            if (_quads_only) {
+                return get_vertex_count() / 4 * 6;
+            }
+            if (_usage == buffer_usage::persistent_ring) {
+                return _ring_ind_count;
+            }
             return _indices.size();
         }
 
+        /// GL_UNSIGNED_SHORT while the shared quad indices can address every vertex
+        [[nodiscard]] GLenum get_index_type() const {
+            return _quads_only ? quad_index_buffer::index_type_for(get_vertex_count()) : GL_UNSIGNED_INT;
+        }
+
+        /// true while all the geometry is quads, drawn through the shared quad_index_buffer
+        [[nodiscard]] bool is_quads_only() const { return _quads_only; }
+
+        [[nodiscard]] buffer_usage get_usage() const { return _usage; }
+
+        /// The coloured_vertex shader features this geometry needs, draw it with
+        /// get_coloured_vertex_shader(get_shader_variant()). Untextured geometry skips the texture
+        /// bind and fetch, textured is the default.
+        void set_shader_variant(shader_variant variant) { _shader_variant = variant; }
+
+        [[nodiscard]] shader_variant get_shader_variant() const { return _shader_variant; }
+
     public:
         void clear() {
+            _quads_only = true;
+
+            if (_usage == buffer_usage::persistent_ring) {
+                // move on to the next frame region, the GPU may still be reading the one we just drew from
+                _ring_region = (_ring_region + 1) % _ring_fences.size();
+                wait_for_ring_region(_ring_region);
+                _ring_vert_count = 0;
+                _ring_ind_count = 0;
+                return;
+            }
             _indices.clear();
             _vertices.clear();
+            if (_arena != nullptr && _arena_generation != _arena->generation()) {
+                // the arena was reset and our storage handed to someone else, drop it without touching it
+                std::pmr::vector<vertex_type>(_arena).swap(_vertices);
+                std::pmr::vector<unsigned int>(_arena).swap(_indices);
+                _arena_generation = _arena->generation();
+            }
+            // anything re-added is marked as it is appended
+            _vert_dirty.clear();
+            _ind_dirty.clear();
+
+            // every handle is released, their generations are never reissued so stale ones are caught
+            _quad_slots.clear();
+            _free_slots.clear();
+            _quad_owners.clear();
+            _free_quad_count = 0;
         }
 
-        void add_quad(const gldraw::rect &rct, const gldraw::colour &colour = gldraw::COL_WHITE,
-                      std::function<const void(vertex_type &vertex)> vertex_callback = nullptr) {
-            unsigned int indx = _vertices.size();
+        /// append a quad
+        /// @return a handle for update_quad and remove_quad, null for persistent_ring managers
+        template<typename TCallback = no_vertex_callback>
+        quad_handle add_quad(const gldraw::rect &rct, const gldraw::colour &colour = gldraw::COL_WHITE,
+                             TCallback &&vertex_callback = {}) {
+            add_quads({&rct, 1}, {&colour, 1}, {}, std::forward<TCallback>(vertex_callback));
+            return retain_last_quad();
+        }
 
-            /// bl, tl, tr, br
-            _vertices.emplace_back(vertex_type(rct.pos, {0.0f, 0.0f}, colour));
-            _vertices.emplace_back(vertex_type(rct.pos + glmath::vec2f(0.0f, rct.size.y), {0.0f, 1.0f}, colour));
-            _vertices.emplace_back(vertex_type(rct.pos + rct.size, {1.0f, 1.0f}, colour));
-            _vertices.emplace_back(vertex_type(rct.pos + glmath::vec2f(rct.size.x, 0.0f), {1.0f, 0.0f}, colour));
-
-            if (vertex_callback) {
-                vertex_callback(_vertices[_vertices.size() - 4]);
-                vertex_callback(_vertices[_vertices.size() - 3]);
-                vertex_callback(_vertices[_vertices.size() - 2]);
-                vertex_callback(_vertices[_vertices.size() - 1]);
-            }
-
-#if defined CCW_WINDING
-            // 0, 3, 1 first triangle
-            _indices.push_back(indx);
-            _indices.push_back(indx + 3);
-            _indices.push_back(indx + 1);
-
-            // 1, 3, 2 second triangle
-            _indices.push_back(indx + 1);
-            _indices.push_back(indx + 3);
-            _indices.push_back(indx + 2);
-#else
-            // 0, 1, 3 first triangle
-            _indices.push_back(indx);
-            _indices.push_back(indx + 1);
-            _indices.push_back(indx + 3);
-
-            // 1, 2, 3 second triangle
-            _indices.push_back(indx + 1);
-            _indices.push_back(indx + 2);
-            _indices.push_back(indx + 3);
-#endif
+        /// Append a quad showing an image packed into a TextureAtlas, its uvs are the image's place on the
+        /// atlas page. Keep one manager per page so all of its quads draw with the page texture bound.
+        template<typename TCallback = no_vertex_callback>
+        quad_handle add_quad(const gldraw::rect &rct, const gldraw::atlas_region &region,
+                             const gldraw::colour &colour = gldraw::COL_WHITE, TCallback &&vertex_callback = {}) {
+            add_quads({&rct, 1}, {&colour, 1}, {&region.uv, 1}, std::forward<TCallback>(vertex_callback));
+            return retain_last_quad();
+        }
+
+        /// true while handle refers to a quad of this manager
+        [[nodiscard]] bool is_valid(quad_handle handle) const {
+            return handle.slot < _quad_slots.size() && _quad_slots[handle.slot].generation == handle.generation &&
+                   _quad_slots[handle.slot].quad != FREE_QUAD;
+        }
+
+        /// rewrite a retained quad in place, only its four vertices are uploaded by the next gen_buffers
+        template<typename TCallback = no_vertex_callback>
+        void update_quad(quad_handle handle, const gldraw::rect &rct, const gldraw::colour &colour = gldraw::COL_WHITE,
+                         const gldraw::rect &uv = gldraw::UV_UNIT, TCallback &&vertex_callback = {}) {
+            assert(is_valid(handle));
+
+            const size_t first = 4 * size_t(_quad_slots[handle.slot].quad);
+            write_quad_vertices(_vertices.data() + first, rct, colour, uv);
+            for (size_t indx = first; indx < first + 4; ++indx) {
+                vertex_callback(_vertices[indx]);
+            }
+            _vert_dirty.add(first, first + 4);
+        }
+
+        /// rewrite a retained quad to show an atlas image, region must be on the same page as before
+        template<typename TCallback = no_vertex_callback>
+        void update_quad(quad_handle handle, const gldraw::rect &rct, const gldraw::atlas_region &region,
+                         const gldraw::colour &colour = gldraw::COL_WHITE, TCallback &&vertex_callback = {}) {
+            update_quad(handle, rct, colour, region.uv, std::forward<TCallback>(vertex_callback));
+        }
+
+        /// Drop a retained quad. Its vertices are collapsed so it draws nothing and the space is reclaimed by
+        /// the next compaction, the handle is invalid from here on.
+        void remove_quad(quad_handle handle) {
+            assert(is_valid(handle));
+
+            quad_slot &slot = _quad_slots[handle.slot];
+            const size_t first = 4 * size_t(slot.quad);
+            std::fill_n(_vertices.begin() + first, 4, vertex_type{});
+            _vert_dirty.add(first, first + 4);
+
+            _quad_owners[slot.quad] = FREE_QUAD;
+            ++_free_quad_count;
+
+            slot.quad = FREE_QUAD;
+            _free_slots.push_back(handle.slot);
+        }
+
+        /// removed quads still occupying space
+        [[nodiscard]] size_t get_free_quad_count() const { return _free_quad_count; }
+
+        /// Close the gaps left by remove_quad, keeping the draw order. Retained handles stay valid, only the
+        /// quads after the first gap move. Called by gen_buffers once enough of the geometry is gaps.
+        /// Managers with indices of their own keep their gaps, the indices need not follow the quad pattern.
+        void compact() {
+            if (_free_quad_count == 0 || !_quads_only || _usage == buffer_usage::persistent_ring) {
+                return;
+            }
+
+            size_t write = 0;
+            size_t first_moved = _quad_owners.size();
+            for (size_t read = 0; read < _quad_owners.size(); ++read) {
+                const uint32_t owner = _quad_owners[read];
+                if (owner == FREE_QUAD) {
+                    first_moved = std::min(first_moved, read);
+                    continue;
+                }
+                if (read != write) {
+                    std::copy_n(_vertices.begin() + 4 * read, 4, _vertices.begin() + 4 * write);
+                    _quad_owners[write] = owner;
+                    if (owner != UNOWNED_QUAD) {
+                        _quad_slots[owner].quad = write;
+                    }
+                }
+                ++write;
+            }
+
+            _quad_owners.resize(write);
+            _vertices.resize(4 * write);
+            _free_quad_count = 0;
+            // earlier updates may lie past the new end
+            _vert_dirty.truncate(_vertices.size());
+            _vert_dirty.add(4 * first_moved, _vertices.size());
+        }
+
+        /// append a quad per rect
+        /// @param colours empty for white or one per rect
+        /// @param uvs empty for the full 0..1 texture or one uv rect per rect
+        /// @param vertex_callback called with each generated vertex before it is stored
+        template<typename TCallback = no_vertex_callback>
+        void add_quads(std::span<const gldraw::rect> rects, std::span<const gldraw::colour> colours = {},
+                       std::span<const gldraw::rect> uvs = {}, TCallback &&vertex_callback = {}) {
+            constexpr bool has_callback = !std::is_same_v<std::decay_t<TCallback>, no_vertex_callback>;
+
+            assert(colours.empty() || colours.size() == rects.size());
+            assert(uvs.empty() || uvs.size() == rects.size());
+            assert(_arena == nullptr || _arena_generation == _arena->generation());
+
+            const size_t count = rects.size();
+            if (count == 0) {
+                return;
+            }
+
+            // a zero stride repeats the default for every quad and keeps the loops branch free
+            const gldraw::colour *p_colours = colours.empty() ? &gldraw::COL_WHITE : colours.data();
+            const size_t colour_stride = colours.empty() ? 0 : 1;
+            const gldraw::rect *p_uvs = uvs.empty() ? &gldraw::UV_UNIT : uvs.data();
+            const size_t uv_stride = uvs.empty() ? 0 : 1;
+
+            vertex_type *p_vert;
+            unsigned int *p_indx;
+            unsigned int first_vert;
+
+            // while quads only the shared quad_index_buffer supplies the indices
+            const size_t index_count = _quads_only ? 0 : 6 * count;
+
+            if (_usage == buffer_usage::persistent_ring) {
+                if (_ring_vert_count + 4 * count > _ring_vert_capacity || _ring_ind_count + index_count > _ring_ind_capacity) {
+                    grow_ring(_ring_vert_count + 4 * count, _ring_ind_count + index_count);
+                }
+                // indices are relative to the region, the draw applies the region base vertex
+                first_vert = _ring_vert_count;
+                p_vert = _ring_vertices + ring_vertex_base() + _ring_vert_count;
+                p_indx = _ring_indices + ring_index_base() + _ring_ind_count;
+                _ring_vert_count += 4 * count;
+                _ring_ind_count += index_count;
+            } else {
+                first_vert = _vertices.size();
+                size_t first_indx = _indices.size();
+
+                _quad_owners.resize(_quad_owners.size() + count, UNOWNED_QUAD);
+
+                _vertices.resize(first_vert + 4 * count);
+                _vert_dirty.add(first_vert, _vertices.size());
+
+                if (index_count != 0) {
+                    _indices.resize(first_indx + index_count);
+                    _ind_dirty.add(first_indx, _indices.size());
+                }
+
+                p_vert = _vertices.data() + first_vert;
+                p_indx = _indices.data() + first_indx;
+            }
+
+            if constexpr (has_callback) {
+                // the ring mapping is write only, the callback works on a local copy
+                for (size_t quad = 0; quad < count; ++quad) {
+                    vertex_type vertices[4];
+                    write_quad_vertices(vertices, rects[quad], p_colours[quad * colour_stride], p_uvs[quad * uv_stride]);
+                    for (vertex_type &vertex: vertices) {
+                        vertex_callback(vertex);
+                    }
+                    std::memcpy(p_vert + 4 * quad, vertices, sizeof(vertices));
+                }
+            } else {
+                for (size_t quad = 0; quad < count; ++quad) {
+                    write_quad_vertices(p_vert + 4 * quad, rects[quad], p_colours[quad * colour_stride], p_uvs[quad * uv_stride]);
+                }
+            }
+
+            if (index_count != 0) {
+                for (size_t quad = 0; quad < count; ++quad) {
+                    write_quad_indices(p_indx + 6 * quad, first_vert + 4 * quad);
+                }
+            }
+        }
+
+        /// Append indexed triangles, leaving quads only mode. The vertices are padded to a whole number of
+        /// quads, so retained quads added later still find their four vertices.
+        /// @param indices three per triangle, relative to the first of vertices
+        /// @param vertex_callback called with each vertex before it is stored
+        /// @return the index of the first vertex, for update_vertices
+        template<typename TCallback = no_vertex_callback>
+        size_t add_triangles(std::span<const vertex_type> vertices, std::span<const unsigned int> indices,
+                             TCallback &&vertex_callback = {}) {
+            assert(indices.size() % 3 == 0);
+            assert(_arena == nullptr || _arena_generation == _arena->generation());
+
+            // the shared quad indices cannot describe these
+            materialise_quad_indices();
+
+            const size_t padded_count = (vertices.size() + 3) & ~size_t(3);
+
+            vertex_type *p_vert;
+            unsigned int *p_indx;
+            size_t first_vert;
+
+            if (_usage == buffer_usage::persistent_ring) {
+                if (_ring_vert_count + padded_count > _ring_vert_capacity || _ring_ind_count + indices.size() > _ring_ind_capacity) {
+                    grow_ring(_ring_vert_count + padded_count, _ring_ind_count + indices.size());
+                }
+                first_vert = _ring_vert_count;
+                p_vert = _ring_vertices + ring_vertex_base() + _ring_vert_count;
+                p_indx = _ring_indices + ring_index_base() + _ring_ind_count;
+                _ring_vert_count += padded_count;
+                _ring_ind_count += indices.size();
+            } else {
+                first_vert = _vertices.size();
+                size_t first_indx = _indices.size();
+
+                _quad_owners.resize(_quad_owners.size() + padded_count / 4, UNOWNED_QUAD);
+
+                _vertices.resize(first_vert + padded_count);
+                _vert_dirty.add(first_vert, _vertices.size());
+                _indices.resize(first_indx + indices.size());
+                _ind_dirty.add(first_indx, _indices.size());
+
+                p_vert = _vertices.data() + first_vert;
+                p_indx = _indices.data() + first_indx;
+            }
+
+            for (size_t indx = 0; indx < vertices.size(); ++indx) {
+                // the ring mapping is write only, the callback works on a local copy
+                vertex_type vertex = vertices[indx];
+                vertex_callback(vertex);
+                p_vert[indx] = vertex;
+            }
+            std::fill(p_vert + vertices.size(), p_vert + padded_count, vertex_type{});
+
+            for (size_t indx = 0; indx < indices.size(); ++indx) {
+                assert(indices[indx] < vertices.size());
+                p_indx[indx] = static_cast<unsigned int>(first_vert) + indices[indx];
+            }
+            return first_vert;
+        }
+
+        /// overwrite existing vertices in place, only the modified span is uploaded by the next gen_buffers
+        void update_vertices(size_t first, std::span<const vertex_type> vertices) {
+            assert(first + vertices.size() <= get_vertex_count());
+
+            if (_usage == buffer_usage::persistent_ring) {
+                std::memcpy(_ring_vertices + ring_vertex_base() + first, vertices.data(), vertices.size_bytes());
+                return;
+            }
+
+            std::copy(vertices.begin(), vertices.end(), _vertices.begin() + first);
+            _vert_dirty.add(first, first + vertices.size());
+        }
+
+        /// modify count existing vertices in place through callback(vertex_type &)
+        /// not available to persistent_ring managers, their mapping is write only
+        template<typename TCallback>
+        void update_vertices(size_t first, size_t count, TCallback &&callback) {
+            assert(_usage != buffer_usage::persistent_ring);
+            assert(first + count <= get_vertex_count());
+
+            for (size_t indx = first; indx < first + count; ++indx) {
+                callback(_vertices[indx]);
+            }
+            _vert_dirty.add(first, first + count);
+        }
+
+        /// overwrite existing indices in place, only the modified span is uploaded by the next gen_buffers
+        void update_indices(size_t first, std::span<const unsigned int> indices) {
+            assert(first + indices.size() <= get_element_count());
+
+            // the shared quad indices are immutable, switch to our own copy of the pattern
+            materialise_quad_indices();
+
+            if (_usage == buffer_usage::persistent_ring) {
+                std::memcpy(_ring_indices + ring_index_base() + first, indices.data(), indices.size_bytes());
+                return;
+            }
+
+            std::copy(indices.begin(), indices.end(), _indices.begin() + first);
+            _ind_dirty.add(first, first + indices.size());
         }
 
     public:
         void gen_buffers() {
+            if (_usage == buffer_usage::persistent_ring) {
+                // the geometry was written straight into the coherent mapping, nothing to upload
+                return;
+            }
+
+            // reclaim removed quads once they are a quarter of the geometry
+            if (_free_quad_count >= COMPACT_MIN_FREE_QUADS && 4 * _free_quad_count >= _quad_owners.size()) {
+                compact();
+            }
+
             glBindVertexArray(_VAO);
 
             glBindBuffer(GL_ARRAY_BUFFER, _VBO);
 
-            void *p_vert_buf = _vertices.data();
-            void *p_index_buf = _indices.data();
+            // a buffer too small for the geometry is reallocated, a static buffer is always respecified
+            if (_vertices.size() > _vert_buf_size || (_usage == buffer_usage::static_draw && !_vert_dirty.empty())) {
+                upload_vertices();
+            } else {
+                // only the modified spans, appended and compacted vertices are among them
+                for (const element_range &range: _vert_dirty.ranges()) {
+                    glBufferSubData(GL_ARRAY_BUFFER, range.begin * sizeof(vertex_type), range.size() * sizeof(vertex_type),
+                                    _vertices.data() + range.begin);
+                }
+#if defined ZINK_BUFFER_CORRUPTION_BUG
+                if (_vertices.size() != _uploaded_vert_count) {
+                    // the end of the vertex data moved, the padding vertex moves with it
+                    glBufferSubData(GL_ARRAY_BUFFER, _vertices.size() * sizeof(vertex_type), sizeof(vertex_type), &_padding_vertex);
+                }
+#endif
+            }
+            _vert_dirty.clear();
+            _uploaded_vert_count = _vertices.size();
 
-            size_t vert_buf_size = _vertices.size() * sizeof(vertex_type);
-            size_t index_buf_size = _indices.size() * sizeof(unsigned int);
+            if (_quads_only) {
+                // nothing to upload, draw binds the shared quad indices
+                return;
+            }
 
-#if defined ZINK_BUFFER_CORRUPTION_BUG
-            // allocate new buffers one element larger
-            std::vector<vertex_type> new_vert_buf(_vertices.size() + 1);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _EBO);
+            _bound_ebo = _EBO;
+            _bound_ebo_generation = 0;
+
+            if (_indices.size() > _ind_buf_size || (_usage == buffer_usage::static_draw && !_ind_dirty.empty())) {
+                upload_indices();
+            } else {
+                for (const element_range &range: _ind_dirty.ranges()) {
+                    glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, range.begin * sizeof(unsigned int), range.size() * sizeof(unsigned int),
+                                    _indices.data() + range.begin);
+                }
+            }
+            _ind_dirty.clear();
+            _uploaded_ind_count = _indices.size();
+        }
+
+        /// draw the current content, the VAO is left bound
+        void draw() {
+            glBindVertexArray(_VAO);
+
+            const GLenum index_type = get_index_type();
+
+            // the shared buffer is replaced when it grows, keep the VAO pointing at the current one. The
+            // replacement may get the old name back, so it is told apart by its generation
+            quad_index_buffer &shared_indices = quad_index_buffer::instance();
+            GLuint ebo = _quads_only ? shared_indices.get_buffer(get_vertex_count() / 4, index_type) : _EBO;
+            uint64_t ebo_generation = _quads_only ? shared_indices.get_generation() : 0;
+            if (ebo != _bound_ebo || ebo_generation != _bound_ebo_generation) {
+                glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+                _bound_ebo = ebo;
+                _bound_ebo_generation = ebo_generation;
+            }
 
-            // populate the new buffer with non zero data
-            //std::memset(new_vert_buf.data(), 0xE5, new_vert_buf.size() * sizeof(vertex_type));
+            if (_usage == buffer_usage::persistent_ring) {
+                // the shared quad indices always start at zero, our own are offset to the region
+                size_t index_offset = _quads_only ? 0 : ring_index_base() * sizeof(unsigned int);
+                glDrawElementsBaseVertex(GL_TRIANGLES, get_element_count(), index_type,
+                                         reinterpret_cast<void *>(index_offset),
+                                         static_cast<GLint>(ring_vertex_base()));
+
+                // fence the region so it is not overwritten while the GPU is still reading it
+                GLsync &fence = _ring_fences[_ring_region];
+                if (fence != nullptr) {
+                    glDeleteSync(fence);
+                }
+                fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+                return;
+            }
 
-            // copy the content from the old to the expanded buffer
-            std::memcpy(new_vert_buf.data(), p_vert_buf, vert_buf_size);
+            glDrawElements(GL_TRIANGLES, get_element_count(), index_type, 0);
+        }
+
+        /// queue an asynchronous check that the GPU buffers still match the staged geometry,
+        /// sampled at the validator's rate. Call after gen_buffers, failures are reported by validator.poll
+        void validate_buffers(BufferValidator &validator, const std::string &label) {
+            if (_usage == buffer_usage::persistent_ring) {
+                // the mapped buffer is the only copy of the geometry, there is nothing to compare against
+                return;
+            }
+            if (_vertices.empty() || !validator.sample()) {
+                return;
+            }
 
-            // use the new
-            p_vert_buf = new_vert_buf.data();
-            vert_buf_size = new_vert_buf.size() * sizeof(vertex_type);
+            // the vertex buffer
+            uint64_t vert_hash = hash_bytes(_vertices.data(), _vertices.size() * sizeof(vertex_type));
+            size_t vert_check_size = _vertices.size() * sizeof(vertex_type);
+#if defined ZINK_BUFFER_CORRUPTION_BUG
+            // check the padding bytes
+            vert_hash = hash_bytes(&_padding_vertex, sizeof(vertex_type), vert_hash);
+            vert_check_size += sizeof(vertex_type);
 #endif
+            validator.submit(_VBO, 0, vert_check_size, vert_hash, label + " vertices");
+
+            // the element buffer, quad only managers draw from the shared quad indices
+            if (!_quads_only && !_indices.empty()) {
+                validator.submit(_EBO, 0, _indices.size() * sizeof(unsigned int),
+                                 hash_bytes(_indices.data(), _indices.size() * sizeof(unsigned int)), label + " indices");
+            }
+        }
+
+        [[nodiscard]] unsigned int get_vbo() const { return _VBO; }
+        [[nodiscard]] unsigned int get_vao() const { return _VAO; }
+        [[nodiscard]] unsigned int get_ebo() const { return _EBO; }
+
+        [[nodiscard]] const void *const get_indicies() const { return _indices.data(); }
+
+        /// the staged vertices, not available to persistent_ring managers
+        [[nodiscard]] std::span<const vertex_type> get_vertices() const {
+            assert(_usage != buffer_usage::persistent_ring);
+            return _vertices;
+        }
+
+        /// the staged indices, empty while quads only
+        [[nodiscard]] std::span<const unsigned int> get_indices() const {
+            assert(_usage != buffer_usage::persistent_ring);
+            return _indices;
+        }
+
+    private:
+        /// upload the complete vertex store, the VBO must be bound
+        void upload_vertices() {
+            size_t vert_buf_size = _vertices.size() * sizeof(vertex_type);
 
             // do we re-use the buffer or generate a new larger one?
-            if (_vertices.size() <= _vert_buf_size && !_static_buffers) {
-                glBufferSubData(GL_ARRAY_BUFFER, 0, vert_buf_size, p_vert_buf);
+            if (_vertices.size() <= _vert_buf_size && _usage == buffer_usage::stream) {
+                glBufferSubData(GL_ARRAY_BUFFER, 0, vert_buf_size, _vertices.data());
             } else {
                 // need to allocate a new larger buffer
-                glBufferData(GL_ARRAY_BUFFER, vert_buf_size, p_vert_buf, _static_buffers ? GL_STATIC_DRAW : GL_STREAM_DRAW);
+#if defined ZINK_BUFFER_CORRUPTION_BUG
+                // size the buffer one element larger, the padding tail is written below
+                glBufferData(GL_ARRAY_BUFFER, vert_buf_size + sizeof(vertex_type), nullptr, _usage == buffer_usage::static_draw ? GL_STATIC_DRAW : GL_STREAM_DRAW);
+                glBufferSubData(GL_ARRAY_BUFFER, 0, vert_buf_size, _vertices.data());
+#else
+                glBufferData(GL_ARRAY_BUFFER, vert_buf_size, _vertices.data(), _usage == buffer_usage::static_draw ? GL_STATIC_DRAW : GL_STREAM_DRAW);
+#endif
                 _vert_buf_size = _vertices.size();
-
-                TVertex::map_vertex_attributes();
             }
 
-            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _EBO);
+#if defined ZINK_BUFFER_CORRUPTION_BUG
+            // the element after the last vertex moves with the vertex count, rewrite it from the shared padding vertex
+            glBufferSubData(GL_ARRAY_BUFFER, vert_buf_size, sizeof(vertex_type), &_padding_vertex);
+#endif
+        }
+
+        /// upload the complete index store, the EBO must be bound
+        void upload_indices() {
+            size_t index_buf_size = _indices.size() * sizeof(unsigned int);
 
             // do we re-use the buffer or generate a new larger one?
-            if (_indices.size() <= _ind_buf_size && !_static_buffers) {
-                glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, index_buf_size, p_index_buf);
+            if (_indices.size() <= _ind_buf_size && _usage == buffer_usage::stream) {
+                glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, index_buf_size, _indices.data());
             } else {
-                glBufferData(GL_ELEMENT_ARRAY_BUFFER, index_buf_size, p_index_buf, _static_buffers ? GL_STATIC_DRAW : GL_STREAM_DRAW);
+                glBufferData(GL_ELEMENT_ARRAY_BUFFER, index_buf_size, _indices.data(), _usage == buffer_usage::static_draw ? GL_STATIC_DRAW : GL_STREAM_DRAW);
                 _ind_buf_size = _indices.size();
             }
         }
 
-        bool test_buffers() {
-            // the vertex buffer
+        /// give the quad just appended by add_quads a retained handle
+        quad_handle retain_last_quad() {
+            if (_usage == buffer_usage::persistent_ring) {
+                // rebuilt every frame, nothing to retain
+                return {};
+            }
+
+            quad_handle handle;
+            if (_free_slots.empty()) {
+                handle.slot = _quad_slots.size();
+                _quad_slots.emplace_back();
+            } else {
+                handle.slot = _free_slots.back();
+                _free_slots.pop_back();
+            }
+            handle.generation = _next_generation++;
+
+            _quad_slots[handle.slot] = {static_cast<uint32_t>(_quad_owners.size() - 1), handle.generation};
+            _quad_owners.back() = handle.slot;
+            return handle;
+        }
+
+        static void write_quad_vertices(vertex_type *dst, const gldraw::rect &rct, const gldraw::colour &colour,
+                                        const gldraw::rect &uv = gldraw::UV_UNIT) {
+            const glmath::vec2f uv_max = uv.pos + uv.size;
+
+            /// bl, tl, tr, br
+            dst[0] = vertex_type(rct.pos, uv.pos, colour);
+            dst[1] = vertex_type(rct.pos + glmath::vec2f(0.0f, rct.size.y), {uv.pos.x, uv_max.y}, colour);
+            dst[2] = vertex_type(rct.pos + rct.size, uv_max, colour);
+            dst[3] = vertex_type(rct.pos + glmath::vec2f(rct.size.x, 0.0f), {uv_max.x, uv.pos.y}, colour);
+        }
+
+        static void write_quad_indices(unsigned int *dst, unsigned int indx) {
+            gldraw::write_quad_indices(dst, indx);
+        }
+
+        /// leave quads only mode, writing the quad pattern for the existing geometry into our own indices
+        void materialise_quad_indices() {
+            if (!_quads_only) {
+                return;
+            }
+            _quads_only = false;
+
+            const size_t quad_count = get_vertex_count() / 4;
+
+            if (_usage == buffer_usage::persistent_ring) {
+                if (6 * quad_count > _ring_ind_capacity) {
+                    grow_ring(_ring_vert_capacity, 6 * quad_count);
+                }
+                for (size_t quad = 0; quad < quad_count; ++quad) {
+                    write_quad_indices(_ring_indices + ring_index_base() + 6 * quad, 4 * quad);
+                }
+                _ring_ind_count = 6 * quad_count;
+                return;
+            }
+
+            _indices.resize(6 * quad_count);
+            for (size_t quad = 0; quad < quad_count; ++quad) {
+                write_quad_indices(_indices.data() + 6 * quad, 4 * quad);
+            }
+            _ind_dirty.add(0, _indices.size());
+        }
+
+    private:
+        size_t ring_vertex_base() const { return _ring_region * _ring_vert_capacity; }
+        size_t ring_index_base() const { return _ring_region * _ring_ind_capacity; }
+
+        void wait_for_ring_region(size_t region) {
+            GLsync &fence = _ring_fences[region];
+            if (fence == nullptr) {
+                return;
+            }
+            GLenum result;
+            do {
+                result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+            } while (result == GL_TIMEOUT_EXPIRED);
+
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+
+        /// create immutable, persistently mapped storage for every region of the ring
+        void allocate_ring(size_t vert_capacity, size_t ind_capacity) {
+            const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            const size_t regions = _ring_fences.size();
+
+            _ring_vert_capacity = vert_capacity;
+            _ring_ind_capacity = ind_capacity;
+
+            glBindVertexArray(_VAO);
+
             glBindBuffer(GL_ARRAY_BUFFER, _VBO);
-            vertex_type *p_vert_buff = static_cast<vertex_type*>(glMapBuffer(GL_ARRAY_BUFFER, GL_READ_ONLY));
-            if (p_vert_buff != nullptr) {
-                if (_vertices.size() > 0) {
-                    assert(_vertices[0] == p_vert_buff[0]);
-                    assert(_vertices[_vertices.size()-1] == p_vert_buff[_vertices.size()-1]);
 #if defined ZINK_BUFFER_CORRUPTION_BUG
-                    // check the padding bytes
-                    assert(p_vert_buff[_vertices.size()] == vertex_type());
+            // one vertex of padding past the final region
+            size_t vert_buf_size = (regions * vert_capacity + 1) * sizeof(vertex_type);
+#else
+            size_t vert_buf_size = regions * vert_capacity * sizeof(vertex_type);
 #endif
-                }
-            }
-            // the element buffer
+            glBufferStorage(GL_ARRAY_BUFFER, vert_buf_size, nullptr, flags);
+            _ring_vertices = static_cast<vertex_type *>(glMapBufferRange(GL_ARRAY_BUFFER, 0, vert_buf_size, flags));
+#if defined ZINK_BUFFER_CORRUPTION_BUG
+            _ring_vertices[regions * vert_capacity] = _padding_vertex;
+#endif
+            bind_vertex_buffer<TVertex>(_VAO, _VBO);
+
             glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _EBO);
-            unsigned int *p_indx_buff = static_cast<unsigned int*>(glMapBuffer(GL_ELEMENT_ARRAY_BUFFER, GL_READ_ONLY));
-            if (p_indx_buff != nullptr) {
-                assert(_indices[0] == p_indx_buff[0]);
-                assert(_indices[_indices.size()-1] == p_indx_buff[_indices.size()-1]);
-            }
+            _bound_ebo = _EBO;
+            _bound_ebo_generation = 0;
+            size_t index_buf_size = regions * ind_capacity * sizeof(unsigned int);
+            glBufferStorage(GL_ELEMENT_ARRAY_BUFFER, index_buf_size, nullptr, flags);
+            _ring_indices = static_cast<unsigned int *>(glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, 0, index_buf_size, flags));
 
-            return true;
+            glBindVertexArray(0);
         }
 
-        [[nodiscard]] unsigned int get_vbo() const { return _VBO; }
-        [[nodiscard]] unsigned int get_vao() const { return _VAO; }
-        [[nodiscard]] unsigned int get_ebo() const { return _EBO; }
+        /// storage is immutable so growing means new buffers, the current region is carried over on the GPU
+        void grow_ring(size_t min_vert_capacity, size_t min_ind_capacity) {
+            for (size_t region = 0; region < _ring_fences.size(); ++region) {
+                wait_for_ring_region(region);
+            }
 
-        [[nodiscard]] const void *const get_indicies() const { return _indices.data(); }
+            GLuint old_vbo = _VBO, old_ebo = _EBO;
+            size_t old_vert_base = ring_vertex_base(), old_ind_base = ring_index_base();
+
+            glCreateBuffers(1, &_VBO);
+            glCreateBuffers(1, &_EBO);
+            _ring_region = 0;
+            allocate_ring(std::max(min_vert_capacity, _ring_vert_capacity * 2),
+                          std::max(min_ind_capacity, _ring_ind_capacity * 2));
+
+            glBindBuffer(GL_COPY_READ_BUFFER, old_vbo);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, _VBO);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, old_vert_base * sizeof(vertex_type), 0,
+                                _ring_vert_count * sizeof(vertex_type));
+
+            glBindBuffer(GL_COPY_READ_BUFFER, old_ebo);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, _EBO);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, old_ind_base * sizeof(unsigned int), 0,
+                                _ring_ind_count * sizeof(unsigned int));
+
+            glBindBuffer(GL_COPY_READ_BUFFER, 0);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+            // deleting a mapped buffer unmaps it
+            glDeleteBuffers(1, &old_vbo);
+            glDeleteBuffers(1, &old_ebo);
+        }
 
     private:
-        bool _static_buffers;
+        /// where a retained quad currently is, quad is FREE_QUAD while the slot is on the free list
+        struct quad_slot {
+            uint32_t quad{};
+            uint32_t generation{};
+        };
+
+        // _quad_owners entries for removed quads and for quads added without keeping a handle
+        static constexpr uint32_t FREE_QUAD = std::numeric_limits<uint32_t>::max();
+        static constexpr uint32_t UNOWNED_QUAD = FREE_QUAD - 1;
+
+        // below this many removed quads gen_buffers leaves the gaps alone
+        static constexpr size_t COMPACT_MIN_FREE_QUADS = 16;
+
+#if defined ZINK_BUFFER_CORRUPTION_BUG
+        // written past the end of the vertex data, validate_buffers checks it survives
+        static inline const vertex_type _padding_vertex{};
+#endif
+
+        buffer_usage _usage;
+        shader_variant _shader_variant{shader_variant::textured};
         unsigned int _VBO{}, _VAO{}, _EBO{};
-        std::vector<vertex_type> _vertices;
-        std::vector<unsigned int> _indices;
+        std::pmr::vector<vertex_type> _vertices;
+        std::pmr::vector<unsigned int> _indices;
+
+        // set when the staging lives in a frame_arena, with the arena generation it was allocated in
+        frame_arena *_arena{};
+        uint64_t _arena_generation{};
 
         size_t _vert_buf_size{};
         size_t _ind_buf_size{};
+
+        // modified ranges not yet uploaded and the element counts the GPU buffers currently hold
+        dirty_ranges _vert_dirty;
+        dirty_ranges _ind_dirty;
+        size_t _uploaded_vert_count{};
+        size_t _uploaded_ind_count{};
+
+        // no indices of our own while everything is quads, the element buffer bound to the VAO
+        bool _quads_only{true};
+        GLuint _bound_ebo{};
+        // quad_index_buffer::get_generation of the shared buffer bound, 0 for our own
+        uint64_t _bound_ebo_generation{};
+
+        // retained quads: the handle slots, slots awaiting reuse and the slot owning each staged quad
+        std::vector<quad_slot> _quad_slots;
+        std::vector<uint32_t> _free_slots;
+        std::vector<uint32_t> _quad_owners;
+        size_t _free_quad_count{};
+        uint32_t _next_generation{};
+
+        // persistent_ring state, one fence per region
+        std::vector<GLsync> _ring_fences;
+        size_t _ring_region{};
+        size_t _ring_vert_capacity{};
+        size_t _ring_ind_capacity{};
+        size_t _ring_vert_count{};
+        size_t _ring_ind_count{};
+        vertex_type *_ring_vertices{};
+        unsigned int *_ring_indices{};
     };
 }
\ No newline at end of file
@@ -0,0 +1,76 @@
+//
+// Created by icarr on 17/10/2026.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace gldraw {
+    /// half open element range [begin, end)
+    struct element_range {
+        size_t begin{};
+        size_t end{};
+
+        size_t size() const { return end - begin; }
+    };
+
+    /// sorted, merged set of modified element ranges awaiting upload
+    class dirty_ranges {
+    public:
+        /// @param merge_gap ranges separated by this many clean elements or fewer are uploaded as one
+        explicit dirty_ranges(size_t merge_gap = 16) : _merge_gap(merge_gap) {}
+
+        void add(size_t begin, size_t end) {
+            if (begin >= end) {
+                return;
+            }
+
+            // most updates are appends or in order, check the tail before searching
+            if (_ranges.empty() || begin > _ranges.back().end + _merge_gap) {
+                _ranges.push_back({begin, end});
+                return;
+            }
+
+            // first range that could merge with the new one
+            auto first = std::lower_bound(_ranges.begin(), _ranges.end(), begin, [this](const element_range &r, size_t b) {
+                return r.end + _merge_gap < b;
+            });
+            // one past the last range that could merge
+            auto last = std::upper_bound(first, _ranges.end(), end, [this](size_t e, const element_range &r) {
+                return e + _merge_gap < r.begin;
+            });
+
+            if (first == last) {
+                _ranges.insert(first, {begin, end});
+                return;
+            }
+
+            first->begin = std::min(first->begin, begin);
+            first->end = std::max((last - 1)->end, end);
+            _ranges.erase(first + 1, last);
+        }
+
+        void clear() { _ranges.clear(); }
+
+        /// drop everything at or past end, for stores that shrank
+        void truncate(size_t end) {
+            while (!_ranges.empty() && _ranges.back().begin >= end) {
+                _ranges.pop_back();
+            }
+            if (!_ranges.empty()) {
+                _ranges.back().end = std::min(_ranges.back().end, end);
+            }
+        }
+
+        [[nodiscard]] bool empty() const { return _ranges.empty(); }
+
+        [[nodiscard]] const std::vector<element_range> &ranges() const { return _ranges; }
+
+    private:
+        size_t _merge_gap;
+        std::vector<element_range> _ranges;
+    };
+}
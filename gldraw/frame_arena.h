@@ -0,0 +1,116 @@
+//
+// Created by icarr on 17/10/2026.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+namespace gldraw {
+    /// Monotonic memory resource for geometry rebuilt every frame. Allocation bumps a pointer through
+    /// blocks that are kept between frames, deallocation does nothing and reset() rewinds to the first
+    /// block in constant time. Containers using it must be emptied or dropped after every reset,
+    /// generation() lets them notice one has happened.
+    class frame_arena : public std::pmr::memory_resource {
+    public:
+        struct statistics {
+            /// bytes handed out since the last reset, alignment padding included
+            size_t used{};
+            /// largest used seen at a reset, size initial_size from this
+            size_t high_water{};
+            /// bytes held in blocks
+            size_t capacity{};
+            size_t block_count{};
+            /// allocations that needed a new block from upstream
+            size_t overflow_count{};
+        };
+
+    public:
+        explicit frame_arena(size_t initial_size = 256 * 1024,
+                             std::pmr::memory_resource *upstream = std::pmr::new_delete_resource()) :
+                _upstream(upstream) {
+            add_block(initial_size);
+        }
+
+        ~frame_arena() override {
+            for (const block &blk: _blocks) {
+                _upstream->deallocate(blk.data, blk.size, alignof(std::max_align_t));
+            }
+        }
+
+        frame_arena(const frame_arena &other) = delete;
+        frame_arena &operator=(const frame_arena &other) = delete;
+
+    public:
+        /// start a new frame, everything allocated before is released at once
+        void reset() {
+            _stats.high_water = std::max(_stats.high_water, _stats.used);
+            _stats.used = 0;
+            _current = 0;
+            _offset = 0;
+            ++_generation;
+        }
+
+        [[nodiscard]] uint64_t generation() const { return _generation; }
+
+        [[nodiscard]] statistics get_statistics() const {
+            statistics stats = _stats;
+            stats.high_water = std::max(stats.high_water, stats.used);
+            return stats;
+        }
+
+    protected:
+        void *do_allocate(size_t bytes, size_t alignment) override {
+            while (true) {
+                block &blk = _blocks[_current];
+                size_t aligned = (_offset + alignment - 1) & ~(alignment - 1);
+                if (aligned + bytes <= blk.size) {
+                    _stats.used += aligned + bytes - _offset;
+                    _offset = aligned + bytes;
+                    return blk.data + aligned;
+                }
+
+                // move on to the next retained block or grow
+                _stats.used += blk.size - _offset;
+                if (_current + 1 == _blocks.size()) {
+                    ++_stats.overflow_count;
+                    add_block(std::max(bytes + alignment, _blocks.back().size * 2));
+                }
+                ++_current;
+                _offset = 0;
+            }
+        }
+
+        void do_deallocate(void *, size_t, size_t) override {
+            // released by reset
+        }
+
+        [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+            return this == &other;
+        }
+
+    private:
+        struct block {
+            std::byte *data{};
+            size_t size{};
+        };
+
+        void add_block(size_t size) {
+            _blocks.push_back({static_cast<std::byte *>(_upstream->allocate(size, alignof(std::max_align_t))), size});
+            _stats.capacity += size;
+            _stats.block_count = _blocks.size();
+        }
+
+    private:
+        std::pmr::memory_resource *_upstream;
+        std::vector<block> _blocks;
+        size_t _current{};
+        size_t _offset{};
+        uint64_t _generation{};
+        statistics _stats;
+    };
+}
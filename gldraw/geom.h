@@ -21,4 +21,7 @@ namespace gldraw {
                     {size.x + 2 * x, size.y + 2 * y}};
         }
     };
+
+    /// uv rect covering the whole texture
+    const gldraw::rect UV_UNIT = {{0.0f, 0.0f}, {1.0f, 1.0f}};
 }
\ No newline at end of file
@@ -0,0 +1,133 @@
+//
+// Created by icarr on 17/10/2026.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include <glad/gl.h>
+
+namespace gldraw {
+    enum class winding {
+        ccw = 0,
+        cw = 1
+    };
+
+#if defined CCW_WINDING
+    constexpr winding DEFAULT_WINDING = winding::ccw;
+#else
+    constexpr winding DEFAULT_WINDING = winding::cw;
+#endif
+
+    /// the six indices of the two triangles of a bl, tl, tr, br quad starting at vertex indx
+    template<winding Winding = DEFAULT_WINDING, typename TIndex>
+    void write_quad_indices(TIndex *dst, TIndex indx) {
+        if constexpr (Winding == winding::ccw) {
+            // 0, 3, 1 first triangle
+            dst[0] = indx;
+            dst[1] = indx + 3;
+            dst[2] = indx + 1;
+
+            // 1, 3, 2 second triangle
+            dst[3] = indx + 1;
+            dst[4] = indx + 3;
+            dst[5] = indx + 2;
+        } else {
+            // 0, 1, 3 first triangle
+            dst[0] = indx;
+            dst[1] = indx + 1;
+            dst[2] = indx + 3;
+
+            // 1, 2, 3 second triangle
+            dst[3] = indx + 1;
+            dst[4] = indx + 2;
+            dst[5] = indx + 3;
+        }
+    }
+
+    /// process wide, immutable element buffers holding the quad index pattern, shared by every
+    /// quad only VertexManager. Grown by replacement, so users compare get_generation() with the
+    /// generation bound to their VAO; a deleted name is soon reused so the name alone cannot tell.
+    class quad_index_buffer {
+    public:
+        /// largest quad count a GL_UNSIGNED_SHORT buffer can address
+        static constexpr size_t MAX_SHORT_QUADS = 65536 / 4;
+
+        static quad_index_buffer &instance(winding w = DEFAULT_WINDING) {
+            static quad_index_buffer buffers[2] = {quad_index_buffer(winding::ccw), quad_index_buffer(winding::cw)};
+            return buffers[static_cast<int>(w)];
+        }
+
+        static GLenum index_type_for(size_t vertex_count) {
+            return vertex_count <= MAX_SHORT_QUADS * 4 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+        }
+
+        /// an element buffer indexing at least quad_count quads with index_type
+        GLuint get_buffer(size_t quad_count, GLenum index_type) {
+            if (index_type == GL_UNSIGNED_SHORT) {
+                assert(quad_count <= MAX_SHORT_QUADS);
+                if (quad_count > _short_indices.quad_capacity || _short_indices.buffer == 0) {
+                    grow<uint16_t>(_short_indices, std::min(capacity_for(quad_count), MAX_SHORT_QUADS));
+                }
+                return _short_indices.buffer;
+            }
+
+            if (quad_count > _int_indices.quad_capacity || _int_indices.buffer == 0) {
+                grow<uint32_t>(_int_indices, capacity_for(quad_count));
+            }
+            return _int_indices.buffer;
+        }
+
+        /// changes every time a buffer is replaced, never 0
+        [[nodiscard]] uint64_t get_generation() const { return _generation; }
+
+    private:
+        struct index_storage {
+            GLuint buffer{};
+            size_t quad_capacity{};
+        };
+
+        explicit quad_index_buffer(winding w) : _winding(w) {}
+
+        static size_t capacity_for(size_t quad_count) {
+            return std::bit_ceil(std::max<size_t>(quad_count, 256));
+        }
+
+        template<typename TIndex>
+        void grow(index_storage &storage, size_t quad_capacity) {
+            std::vector<TIndex> indices(quad_capacity * 6);
+            for (size_t quad = 0; quad < quad_capacity; ++quad) {
+                if (_winding == winding::ccw) {
+                    write_quad_indices<winding::ccw>(indices.data() + 6 * quad, static_cast<TIndex>(4 * quad));
+                } else {
+                    write_quad_indices<winding::cw>(indices.data() + 6 * quad, static_cast<TIndex>(4 * quad));
+                }
+            }
+
+            // VAOs still referencing the old buffer keep it alive until they rebind
+            if (storage.buffer != 0) {
+                glDeleteBuffers(1, &storage.buffer);
+            }
+
+            // use the copy target so the element binding of whatever VAO is bound is untouched
+            glGenBuffers(1, &storage.buffer);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, storage.buffer);
+            glBufferStorage(GL_COPY_WRITE_BUFFER, indices.size() * sizeof(TIndex), indices.data(), 0);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+            storage.quad_capacity = quad_capacity;
+            ++_generation;
+        }
+
+    private:
+        winding _winding;
+        index_storage _short_indices;
+        index_storage _int_indices;
+        uint64_t _generation{1};
+    };
+}
@@ -2,23 +2,58 @@
 // Created by icarr on 15/01/2023.
 //
 
-#include <stdexcept>
-#include <format>
+#include <string>
 
 #include "coloured_vertex.h"
+#include "shader_program.h"
 
 namespace gldraw {
-    static GLuint __gauge_shader_id;
+    static GLuint __gauge_shader_ids[SHADER_VARIANT_COUNT];
+    static GLuint __batched_gauge_shader_id;
+    static GLuint __bindless_gauge_shader_id;
+    static GLuint __batched_bindless_gauge_shader_id;
 
-    GLuint get_coloured_vertex_shader() {
-        if (__gauge_shader_id != 0) {
-            return __gauge_shader_id;
+    // the handle is the same for every fragment of a draw, keeping the sampler dynamically uniform
+    static const char *__bindless_fs_str = R"term(
+                #version 460 core
+                #extension GL_ARB_bindless_texture : require
+                out vec4 FragColor;
+
+                flat in vec4 ourForeColor;
+                flat in uint TexIndex;
+                in vec2 TexCoord;
+
+                layout (std430, binding = 1) readonly buffer texture_handles {
+                    uvec2 handle[];
+                };
+
+                void main() {
+                    FragColor = texture(sampler2D(handle[TexIndex]), TexCoord) * ourForeColor;
+                }
+                )term";
+
+    GLuint get_coloured_vertex_shader(shader_variant variant) {
+        GLuint &shader_id = __gauge_shader_ids[static_cast<uint32_t>(variant)];
+        if (shader_id != 0) {
+            return shader_id;
         }
 
-        char infoLog[512];
+        // the features go between the #version line and the shared source
+        std::string defines = "#version 460 core\n";
+        if (has_feature(variant, shader_variant::textured) || has_feature(variant, shader_variant::sdf)) {
+            defines += "#define TEXTURED\n";
+        }
+        if (has_feature(variant, shader_variant::sdf)) {
+            defines += "#define SDF\n";
+        }
+        if (has_feature(variant, shader_variant::alpha_test)) {
+            defines += "#define ALPHA_TEST\n";
+        }
+        if (has_feature(variant, shader_variant::premultiplied)) {
+            defines += "#define PREMULTIPLIED\n";
+        }
 
         const char *vs_str = R"term(
-                #version 460 core
                 layout (location = 0) in vec3 aPos;
                 layout (location = 1) in vec2 aTexCoord;
                 layout (location = 2) in vec4 aForeColor;
@@ -26,11 +61,80 @@ namespace gldraw {
                 uniform mat4 projection;
                 uniform mat4 model;
                 flat out vec4 ourForeColor;
+                #ifdef TEXTURED
                 out vec2 TexCoord;
+                #endif
 
                 void main(){
                     gl_Position = projection * model * vec4(aPos, 1.0);
                     ourForeColor = aForeColor;
+                #ifdef TEXTURED
+                    TexCoord = aTexCoord;
+                #endif
+                }
+                )term";
+
+        const char *fs_str = R"term(
+                out vec4 FragColor;
+
+                flat in vec4 ourForeColor;
+                #ifdef TEXTURED
+                in vec2 TexCoord;
+
+                uniform sampler2D our_texture;
+                #endif
+
+                void main() {
+                #if defined(SDF)
+                    // smooth over one pixel's change in distance so the edge stays crisp at any scale
+                    float distance = texture(our_texture, TexCoord).a;
+                    float edge = max(fwidth(distance), 1.0e-4);
+                    vec4 colour = vec4(ourForeColor.rgb, ourForeColor.a * smoothstep(0.5 - edge, 0.5 + edge, distance));
+                #elif defined(TEXTURED)
+                    vec4 colour = texture(our_texture, TexCoord) * ourForeColor;
+                #else
+                    vec4 colour = ourForeColor;
+                #endif
+                #ifdef ALPHA_TEST
+                    if (colour.a < 0.5) {
+                        discard;
+                    }
+                #endif
+                #ifdef PREMULTIPLIED
+                    colour.rgb *= colour.a;
+                #endif
+                    FragColor = colour;
+                }
+                )term";
+
+        shader_id = link_shader_program(defines + vs_str, defines + fs_str);
+
+        return shader_id;
+    }
+
+    GLuint get_batched_coloured_vertex_shader() {
+        if (__batched_gauge_shader_id != 0) {
+            return __batched_gauge_shader_id;
+        }
+
+        const char *vs_str = R"term(
+                #version 460 core
+                layout (location = 0) in vec3 aPos;
+                layout (location = 1) in vec2 aTexCoord;
+                layout (location = 2) in vec4 aForeColor;
+
+                // one model matrix per draw of the batch
+                layout (std430, binding = 0) readonly buffer model_matrices {
+                    mat4 model[];
+                };
+
+                uniform mat4 projection;
+                flat out vec4 ourForeColor;
+                out vec2 TexCoord;
+
+                void main(){
+                    gl_Position = projection * model[gl_DrawID] * vec4(aPos, 1.0);
+                    ourForeColor = aForeColor;
                     TexCoord = aTexCoord;
                 }
                 )term";
@@ -49,39 +153,76 @@ namespace gldraw {
                 }
                 )term";
 
-        GLuint vs = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vs, 1, &vs_str, nullptr);
-        glCompileShader(vs);
-        int success = -1;
-        glGetShaderiv(vs, GL_COMPILE_STATUS, &success);
-        if (GL_TRUE != success) {
-            glGetShaderInfoLog(vs, 512, nullptr, infoLog);
-            throw std::runtime_error(std::format("Vertex shader compilation failed:\n{}", infoLog));
-        }
+        __batched_gauge_shader_id = link_shader_program(vs_str, fs_str);
+
+        return __batched_gauge_shader_id;
+    }
 
-        GLuint fs = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fs, 1, &fs_str, nullptr);
-        glCompileShader(fs);
-        glGetShaderiv(fs, GL_COMPILE_STATUS, &success);
-        if (GL_TRUE != success) {
-            glGetShaderInfoLog(fs, 512, nullptr, infoLog);
-            throw std::runtime_error(std::format("Fragment shader compilation failed:\n{}", infoLog));
+    GLuint get_bindless_coloured_vertex_shader() {
+        if (__bindless_gauge_shader_id != 0) {
+            return __bindless_gauge_shader_id;
         }
 
-        __gauge_shader_id = glCreateProgram();
-        glAttachShader(__gauge_shader_id, vs);
-        glAttachShader(__gauge_shader_id, fs);
-        glLinkProgram(__gauge_shader_id);
-        glGetProgramiv(__gauge_shader_id, GL_LINK_STATUS, &success);
-        if (GL_TRUE != success) {
-            glGetProgramInfoLog(__gauge_shader_id, 512, NULL, infoLog);
-            throw std::runtime_error(std::format("Shader link  failed:\n{}", infoLog));
+        const char *vs_str = R"term(
+                #version 460 core
+                layout (location = 0) in vec3 aPos;
+                layout (location = 1) in vec2 aTexCoord;
+                layout (location = 2) in vec4 aForeColor;
+
+                uniform mat4 projection;
+                uniform mat4 model;
+                uniform int texture_index;
+                flat out vec4 ourForeColor;
+                flat out uint TexIndex;
+                out vec2 TexCoord;
+
+                void main(){
+                    gl_Position = projection * model * vec4(aPos, 1.0);
+                    ourForeColor = aForeColor;
+                    TexIndex = uint(texture_index);
+                    TexCoord = aTexCoord;
+                }
+                )term";
+
+        __bindless_gauge_shader_id = link_shader_program(vs_str, __bindless_fs_str);
+
+        return __bindless_gauge_shader_id;
+    }
+
+    GLuint get_batched_bindless_coloured_vertex_shader() {
+        if (__batched_bindless_gauge_shader_id != 0) {
+            return __batched_bindless_gauge_shader_id;
         }
 
-        // we can delete the component shaders now we have linked the program
-        glDeleteShader(vs);
-        glDeleteShader(fs);
+        const char *vs_str = R"term(
+                #version 460 core
+                layout (location = 0) in vec3 aPos;
+                layout (location = 1) in vec2 aTexCoord;
+                layout (location = 2) in vec4 aForeColor;
+
+                // one model matrix and texture per draw of the batch
+                layout (std430, binding = 0) readonly buffer model_matrices {
+                    mat4 model[];
+                };
+                layout (std430, binding = 2) readonly buffer draw_textures {
+                    uint draw_texture[];
+                };
+
+                uniform mat4 projection;
+                flat out vec4 ourForeColor;
+                flat out uint TexIndex;
+                out vec2 TexCoord;
+
+                void main(){
+                    gl_Position = projection * model[gl_DrawID] * vec4(aPos, 1.0);
+                    ourForeColor = aForeColor;
+                    TexIndex = draw_texture[gl_DrawID];
+                    TexCoord = aTexCoord;
+                }
+                )term";
+
+        __batched_bindless_gauge_shader_id = link_shader_program(vs_str, __bindless_fs_str);
 
-        return __gauge_shader_id;
+        return __batched_bindless_gauge_shader_id;
     }
 }
\ No newline at end of file
@@ -4,9 +4,16 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
 #include <glad/gl.h>
 
 #include <gldraw/colour.h>
+#include <gldraw/shaders/shader_variant.h>
+#include <gldraw/vertex_layout.h>
 #include <glmath/vectors.h>
 #include <glmath/matrices.h>
 
@@ -37,26 +44,78 @@ namespace gldraw {
             return !(rhs == *this);
         }
 
-        static void map_vertex_attributes() {
-            // these attributes match a shader layout like this:
-            //        #version 330 core
-            //        layout (location = 0) in vec3 aPos;
-            //        layout (location = 1) in vec2 aTexCoord;
-            //        layout (location = 2) in vec4 aColor;
+        static const std::array<vertex_attribute, 3> attributes;
+    };
+
+    // these attributes match a shader layout like this:
+    //        #version 330 core
+    //        layout (location = 0) in vec3 aPos;
+    //        layout (location = 1) in vec2 aTexCoord;
+    //        layout (location = 2) in vec4 aColor;
+    inline constexpr std::array<vertex_attribute, 3> coloured_vertex::attributes{{
+            {0, 3, GL_FLOAT, GL_FALSE, offsetof(coloured_vertex, position)},
+            {1, 2, GL_FLOAT, GL_FALSE, offsetof(coloured_vertex, uv)},
+            {2, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(coloured_vertex, fore_colour)}
+    }};
+
+    /// 16 byte coloured_vertex for 2D geometry drawn with the same shaders, uvs are limited to 0..1
+    struct compact_vertex {
+        // location, z is always 0
+        glmath::vec2f position{};
+        // UV, normalised unsigned shorts
+        uint16_t uv[2]{};
+        // colours
+        gldraw::colour fore_colour{};
 
-            // position attribute
-            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(coloured_vertex), (void *) offsetof(coloured_vertex, position));
-            glEnableVertexAttribArray(0);
+        compact_vertex() = default;
+        explicit compact_vertex(glmath::vec2f position,
+                                glmath::vec2f uv = {0.0f, 0.0f},
+                                gldraw::colour fore_colour = {255, 255, 255, 255}) :
+                position(position), uv{to_unorm16(uv.x), to_unorm16(uv.y)}, fore_colour(fore_colour) {}
 
-            // texture coord attribute
-            glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(coloured_vertex), (void *) offsetof(coloured_vertex, uv));
-            glEnableVertexAttribArray(1);
+        compact_vertex &apply_transform(const glmath::mat4x4 &transform) {
+            position = (transform * glmath::vec4f(position)).to_vec2_hmgns();
+            return *this;
+        };
 
-            // fore_color attribute
-            glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(coloured_vertex), (void *) offsetof(coloured_vertex, fore_colour));
-            glEnableVertexAttribArray(2);
+        bool operator==(const compact_vertex &rhs) const {
+            return std::tie(position, uv[0], uv[1], fore_colour) == std::tie(rhs.position, rhs.uv[0], rhs.uv[1], rhs.fore_colour);
+        }
+        bool operator!=(const compact_vertex &rhs) const {
+            return !(rhs == *this);
         }
+
+        static uint16_t to_unorm16(float value) {
+            return static_cast<uint16_t>(std::clamp(value, 0.0f, 1.0f) * 65535.0f + 0.5f);
+        }
+
+        static const std::array<vertex_attribute, 3> attributes;
     };
+    static_assert(sizeof(compact_vertex) == 16);
+
+    // the shader's vec3 aPos takes z = 0 and vec2 aTexCoord is normalised back to 0..1
+    inline constexpr std::array<vertex_attribute, 3> compact_vertex::attributes{{
+            {0, 2, GL_FLOAT, GL_FALSE, offsetof(compact_vertex, position)},
+            {1, 2, GL_UNSIGNED_SHORT, GL_TRUE, offsetof(compact_vertex, uv)},
+            {2, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(compact_vertex, fore_colour)}
+    }};
+
+    /// the coloured_vertex program with the features of variant compiled in, each variant is built once
+    GLuint get_coloured_vertex_shader(shader_variant variant = shader_variant::textured);
+
+    /// get_coloured_vertex_shader for multi draw indirect batches, the model matrix comes from a
+    /// shader storage buffer at binding MODEL_MATRIX_BINDING indexed by gl_DrawID
+    GLuint get_batched_coloured_vertex_shader();
+
+    constexpr GLuint MODEL_MATRIX_BINDING = 0;
+
+    /// get_coloured_vertex_shader sampling through GL_ARB_bindless_texture, the texture is entry
+    /// texture_index of the BindlessTextures table rather than the texture bound to unit 0
+    GLuint get_bindless_coloured_vertex_shader();
+
+    /// get_batched_coloured_vertex_shader sampling through GL_ARB_bindless_texture, each draw's entry in
+    /// the BindlessTextures table comes from a shader storage buffer at DRAW_TEXTURE_BINDING
+    GLuint get_batched_bindless_coloured_vertex_shader();
 
-    GLuint get_coloured_vertex_shader();
+    constexpr GLuint DRAW_TEXTURE_BINDING = 2;
 }
\ No newline at end of file
@@ -0,0 +1,73 @@
+//
+// Created by icarr on 17/10/2026.
+//
+
+#include <string>
+
+#include <gldraw/quad_indices.h>
+
+#include "instanced_quad.h"
+#include "shader_program.h"
+
+namespace gldraw {
+    static GLuint __instanced_quad_shader_id;
+
+    GLuint get_instanced_quad_shader() {
+        if (__instanced_quad_shader_id != 0) {
+            return __instanced_quad_shader_id;
+        }
+
+        // strip order of the bl, tl, tr, br corners giving front facing triangles for our winding
+        const char *corners_str = DEFAULT_WINDING == winding::ccw ?
+                                  "const vec2 corners[4] = vec2[4](vec2(0.0, 0.0), vec2(1.0, 0.0), vec2(0.0, 1.0), vec2(1.0, 1.0));\n" :
+                                  "const vec2 corners[4] = vec2[4](vec2(0.0, 0.0), vec2(0.0, 1.0), vec2(1.0, 0.0), vec2(1.0, 1.0));\n";
+
+        std::string vs_str = R"term(
+                #version 460 core
+                layout (location = 0) in vec4 aRect;
+                layout (location = 1) in vec4 aUVRect;
+                layout (location = 2) in vec4 aForeColor;
+                layout (location = 3) in float aRotation;
+
+                uniform mat4 projection;
+                uniform mat4 model;
+                flat out vec4 ourForeColor;
+                out vec2 TexCoord;
+                )term";
+        vs_str += corners_str;
+        vs_str += R"term(
+                void main(){
+                    vec2 corner = corners[gl_VertexID];
+
+                    // rotate the corner about the centre of the rect
+                    vec2 half_size = aRect.zw * 0.5;
+                    vec2 offset = (corner - 0.5) * aRect.zw;
+                    float s = sin(aRotation);
+                    float c = cos(aRotation);
+                    vec2 pos = aRect.xy + half_size + vec2(c * offset.x - s * offset.y, s * offset.x + c * offset.y);
+
+                    gl_Position = projection * model * vec4(pos, 0.0, 1.0);
+                    ourForeColor = aForeColor;
+                    TexCoord = aUVRect.xy + corner * aUVRect.zw;
+                }
+                )term";
+
+        const char *fs_str = R"term(
+                #version 460 core
+                out vec4 FragColor;
+
+                flat in vec4 ourForeColor;
+                in vec2 TexCoord;
+
+                uniform sampler2D our_texture;
+
+                void main() {
+                    FragColor = texture(our_texture, TexCoord) * ourForeColor;
+                }
+                )term";
+
+        __instanced_quad_shader_id = link_shader_program(vs_str, fs_str);
+
+        return __instanced_quad_shader_id;
+    }
+}
@@ -0,0 +1,67 @@
+//
+// Created by icarr on 17/10/2026.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <glad/gl.h>
+
+#include <gldraw/colour.h>
+#include <gldraw/geom.h>
+#include <gldraw/vertex_layout.h>
+#include <glmath/vectors.h>
+
+namespace gldraw {
+    /// one quad drawn by the instanced quad shader, the corners are expanded in the vertex shader
+    struct quad_instance {
+        // bottom left corner and size
+        glmath::vec2f position{};
+        glmath::vec2f size{};
+        // uv rect, normalised 0..1
+        uint16_t uv[4]{};
+        // colours
+        gldraw::colour fore_colour{};
+        // radians counter clockwise about the centre of the rect
+        float rotation{};
+
+        quad_instance() = default;
+        quad_instance(const gldraw::rect &rct, const gldraw::rect &uv_rect = gldraw::UV_UNIT,
+                      gldraw::colour fore_colour = {255, 255, 255, 255}, float rotation = 0.0f) :
+                position(rct.pos), size(rct.size), fore_colour(fore_colour), rotation(rotation) {
+            uv[0] = to_unorm16(uv_rect.pos.x);
+            uv[1] = to_unorm16(uv_rect.pos.y);
+            uv[2] = to_unorm16(uv_rect.size.x);
+            uv[3] = to_unorm16(uv_rect.size.y);
+        }
+
+        static uint16_t to_unorm16(float value) {
+            return static_cast<uint16_t>(std::clamp(value, 0.0f, 1.0f) * 65535.0f + 0.5f);
+        }
+
+        static const std::array<vertex_attribute, 4> attributes;
+    };
+    static_assert(sizeof(quad_instance) == 32);
+
+    // one entry per instance, these attributes match the layout in get_instanced_quad_shader:
+    //        layout (location = 0) in vec4 aRect;
+    //        layout (location = 1) in vec4 aUVRect;
+    //        layout (location = 2) in vec4 aForeColor;
+    //        layout (location = 3) in float aRotation;
+    // aRect reads position and size as one vec4
+    inline constexpr std::array<vertex_attribute, 4> quad_instance::attributes{{
+            {0, 4, GL_FLOAT, GL_FALSE, offsetof(quad_instance, position)},
+            {1, 4, GL_UNSIGNED_SHORT, GL_TRUE, offsetof(quad_instance, uv)},
+            {2, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(quad_instance, fore_colour)},
+            {3, 1, GL_FLOAT, GL_FALSE, offsetof(quad_instance, rotation)}
+    }};
+    static_assert(offsetof(quad_instance, size) == offsetof(quad_instance, position) + sizeof(glmath::vec2f));
+
+    /// companion of get_coloured_vertex_shader drawing quad_instance records as 4 vertex triangle strips,
+    /// same uniforms (projection, model, our_texture) and the same output for the same quads
+    GLuint get_instanced_quad_shader();
+}
@@ -0,0 +1,125 @@
+//
+// Created by icarr on 17/10/2026.
+//
+
+#include <string>
+
+#include <gldraw/quad_indices.h>
+
+#include "sdf_primitive.h"
+#include "shader_program.h"
+
+namespace gldraw {
+    static GLuint __sdf_primitive_shader_id;
+
+    GLuint get_sdf_primitive_shader() {
+        if (__sdf_primitive_shader_id != 0) {
+            return __sdf_primitive_shader_id;
+        }
+
+        // strip order of the bl, tl, tr, br corners giving front facing triangles for our winding
+        const char *corners_str = DEFAULT_WINDING == winding::ccw ?
+                                  "const vec2 corners[4] = vec2[4](vec2(-1.0, -1.0), vec2(1.0, -1.0), vec2(-1.0, 1.0), vec2(1.0, 1.0));\n" :
+                                  "const vec2 corners[4] = vec2[4](vec2(-1.0, -1.0), vec2(-1.0, 1.0), vec2(1.0, -1.0), vec2(1.0, 1.0));\n";
+
+        std::string vs_str = R"term(
+                #version 460 core
+                layout (location = 0) in vec4 aBounds;
+                layout (location = 1) in vec4 aParams;
+                layout (location = 2) in vec4 aForeColor;
+                layout (location = 3) in float aRotation;
+                layout (location = 4) in uint aShape;
+
+                uniform mat4 projection;
+                uniform mat4 model;
+                flat out vec4 ourForeColor;
+                flat out vec4 Params;
+                flat out uint Shape;
+                // position relative to the centre before rotation, where the distance is evaluated
+                out vec2 Local;
+                )term";
+        vs_str += corners_str;
+        vs_str += R"term(
+                void main(){
+                    vec2 offset = corners[gl_VertexID] * aBounds.zw;
+
+                    // rotate the corner about the centre
+                    float s = sin(aRotation);
+                    float c = cos(aRotation);
+                    vec2 pos = aBounds.xy + vec2(c * offset.x - s * offset.y, s * offset.x + c * offset.y);
+
+                    gl_Position = projection * model * vec4(pos, 0.0, 1.0);
+                    ourForeColor = aForeColor;
+                    Params = aParams;
+                    Shape = aShape;
+                    Local = offset;
+                }
+                )term";
+
+        const char *fs_str = R"term(
+                #version 460 core
+                out vec4 FragColor;
+
+                flat in vec4 ourForeColor;
+                flat in vec4 Params;
+                flat in uint Shape;
+                in vec2 Local;
+
+                // the sdf_shape values
+                const uint CIRCLE = 0u;
+                const uint RING = 1u;
+                const uint ARC = 2u;
+                const uint CAPSULE = 3u;
+                const uint ROUNDED_RECT = 4u;
+
+                float arc_distance(vec2 p, float radius, float thickness, float start, float sweep) {
+                    // turn the middle of the arc to +y, then it is symmetric about x = 0
+                    float middle = start + 0.5 * sweep - 1.5707963;
+                    float s = sin(middle);
+                    float c = cos(middle);
+                    p = vec2(c * p.x + s * p.y, c * p.y - s * p.x);
+                    p.x = abs(p.x);
+
+                    float half_sweep = min(0.5 * abs(sweep), 3.1415927);
+                    vec2 end = vec2(sin(half_sweep), cos(half_sweep));
+                    // past the ends the nearest point is an end, otherwise the circle
+                    float d = end.y * p.x > end.x * p.y ? length(p - end * radius) : abs(length(p) - radius);
+                    return d - 0.5 * thickness;
+                }
+
+                float rounded_rect_distance(vec2 p, vec2 half_size, float corner_radius, float outline) {
+                    vec2 q = abs(p) - half_size + corner_radius;
+                    float d = length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) - corner_radius;
+                    // an outline lies inside the rect's edge
+                    return outline > 0.0 ? abs(d + 0.5 * outline) - 0.5 * outline : d;
+                }
+
+                void main() {
+                    float d;
+                    if (Shape == RING) {
+                        d = abs(length(Local) - Params.x) - 0.5 * Params.y;
+                    } else if (Shape == ARC) {
+                        d = arc_distance(Local, Params.x, Params.y, Params.z, Params.w);
+                    } else if (Shape == CAPSULE) {
+                        vec2 q = vec2(Local.x - clamp(Local.x, -Params.x, Params.x), Local.y);
+                        d = length(q) - Params.y;
+                    } else if (Shape == ROUNDED_RECT) {
+                        d = rounded_rect_distance(Local, Params.xy, Params.z, Params.w);
+                    } else {
+                        d = length(Local) - Params.x;
+                    }
+
+                    // one pixel wide ramp across the edge at any scale
+                    float coverage = clamp(0.5 - d / max(fwidth(d), 1e-4), 0.0, 1.0);
+                    if (coverage <= 0.0) {
+                        discard;
+                    }
+                    FragColor = vec4(ourForeColor.rgb, ourForeColor.a * coverage);
+                }
+                )term";
+
+        __sdf_primitive_shader_id = link_shader_program(vs_str, fs_str);
+
+        return __sdf_primitive_shader_id;
+    }
+}
@@ -0,0 +1,81 @@
+//
+// Created by icarr on 17/10/2026.
+//
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <glad/gl.h>
+
+#include <gldraw/colour.h>
+#include <gldraw/vertex_layout.h>
+#include <glmath/vectors.h>
+
+namespace gldraw {
+    /// the distance function a primitive's fragments evaluate, params are in sdf_primitive_instance
+    enum class sdf_shape : uint32_t {
+        /// params.x radius
+        circle = 0,
+        /// params.x radius of the centre line, params.y thickness
+        ring = 1,
+        /// params.x radius of the centre line, params.y thickness, params.z start angle, params.w sweep,
+        /// radians counter clockwise from +x, round ended
+        arc = 2,
+        /// params.x half the distance between the end centres along x, params.y radius
+        capsule = 3,
+        /// params.xy half size, params.z corner radius, params.w outline thickness or 0 for filled
+        rounded_rect = 4,
+    };
+
+    /// one primitive drawn by the sdf primitive shader as a single quad, coverage is evaluated from the
+    /// shape's signed distance so edges are anti-aliased without MSAA
+    struct sdf_primitive_instance {
+        // centre and half size of the bounding quad before rotation
+        glmath::vec2f centre{};
+        glmath::vec2f half_size{};
+        // shape parameters, see sdf_shape
+        float params[4]{};
+        // colours
+        gldraw::colour fore_colour{};
+        // radians counter clockwise about the centre
+        float rotation{};
+        sdf_shape shape{sdf_shape::circle};
+
+        /// added around every shape so the quad covers its anti-aliased edge, in the units of the
+        /// projection, pixels for the displays
+        static constexpr float EDGE_MARGIN = 1.5f;
+
+        sdf_primitive_instance() = default;
+        sdf_primitive_instance(sdf_shape shape, glmath::vec2f centre, glmath::vec2f shape_half_size,
+                               float param0, float param1 = 0.0f, float param2 = 0.0f, float param3 = 0.0f,
+                               gldraw::colour fore_colour = {255, 255, 255, 255}, float rotation = 0.0f) :
+                centre(centre), half_size(shape_half_size + glmath::vec2f(EDGE_MARGIN, EDGE_MARGIN)),
+                params{param0, param1, param2, param3}, fore_colour(fore_colour), rotation(rotation), shape(shape) {}
+
+        static const std::array<vertex_attribute, 5> attributes;
+    };
+    static_assert(sizeof(sdf_primitive_instance) == 44);
+
+    // one entry per instance, these attributes match the layout in get_sdf_primitive_shader:
+    //        layout (location = 0) in vec4 aBounds;
+    //        layout (location = 1) in vec4 aParams;
+    //        layout (location = 2) in vec4 aForeColor;
+    //        layout (location = 3) in float aRotation;
+    //        layout (location = 4) in uint aShape;
+    // aBounds reads centre and half size as one vec4
+    inline constexpr std::array<vertex_attribute, 5> sdf_primitive_instance::attributes{{
+            {0, 4, GL_FLOAT, GL_FALSE, offsetof(sdf_primitive_instance, centre)},
+            {1, 4, GL_FLOAT, GL_FALSE, offsetof(sdf_primitive_instance, params)},
+            {2, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(sdf_primitive_instance, fore_colour)},
+            {3, 1, GL_FLOAT, GL_FALSE, offsetof(sdf_primitive_instance, rotation)},
+            {4, 1, GL_UNSIGNED_INT, GL_FALSE, offsetof(sdf_primitive_instance, shape), true}
+    }};
+    static_assert(offsetof(sdf_primitive_instance, half_size) == offsetof(sdf_primitive_instance, centre) + sizeof(glmath::vec2f));
+
+    /// draws sdf_primitive_instance records as 4 vertex triangle strips with uniforms projection and model,
+    /// the colour's alpha is scaled by coverage so it wants GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA blending
+    GLuint get_sdf_primitive_shader();
+}
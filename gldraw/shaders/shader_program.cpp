@@ -0,0 +1,291 @@
+//
+// Created by icarr on 17/10/2026.
+//
+
+#include <stdexcept>
+#include <format>
+#include <fstream>
+#include <cstdint>
+#include <cstring>
+#include <system_error>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <XPLMUtilities.h>
+
+#include <gldraw/BufferValidator.h>
+#include <gldraw/temp_file.h>
+
+#include "shader_program.h"
+
+// from GL_KHR_parallel_shader_compile, not in our glad build
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+namespace gldraw {
+    namespace {
+        constexpr char PROGRAM_MAGIC[8] = {'G', 'L', 'D', 'P', 'R', 'O', 'G', '\0'};
+        constexpr uint32_t PROGRAM_CACHE_VERSION = 1;
+
+        /// fixed header of a cache file, followed by the program binary
+        struct program_header {
+            char magic[8]{};
+            uint32_t version{};
+            uint32_t binary_format{};
+            uint64_t key{};
+            uint32_t binary_size{};
+            uint32_t reserved{};
+        };
+        static_assert(sizeof(program_header) == 32);
+
+        /// a program whose compile and link are running in the driver's threads
+        struct pending_program {
+            GLuint vs{};
+            GLuint fs{};
+            uint64_t key{};
+        };
+
+        std::filesystem::path __cache_folder;
+        std::unordered_map<GLuint, pending_program> __pending;
+        // background compiles that failed, never ready
+        std::unordered_set<GLuint> __failed;
+        program_cache_statistics __statistics;
+
+        /// GL_KHR_parallel_shader_compile or the ARB version, checked once
+        bool has_parallel_shader_compile() {
+            static int __supported = -1;
+
+            if (__supported < 0) {
+                __supported = 0;
+                GLint count = 0;
+                glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+                for (GLint indx = 0; indx < count; ++indx) {
+                    const char *name = reinterpret_cast<const char *>(glGetStringi(GL_EXTENSIONS, indx));
+                    if (name != nullptr && (std::strcmp(name, "GL_KHR_parallel_shader_compile") == 0 ||
+                                            std::strcmp(name, "GL_ARB_parallel_shader_compile") == 0)) {
+                        __supported = 1;
+                        break;
+                    }
+                }
+            }
+            return __supported == 1;
+        }
+
+        /// a binary only loads on the driver that produced it
+        uint64_t driver_hash() {
+            static uint64_t __hash = 0;
+
+            if (__hash == 0) {
+                __hash = FNV1A_OFFSET;
+                for (GLenum name: {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+                    const char *value = reinterpret_cast<const char *>(glGetString(name));
+                    if (value != nullptr) {
+                        __hash = hash_bytes(value, std::strlen(value) + 1, __hash);
+                    }
+                }
+            }
+            return __hash;
+        }
+
+        std::filesystem::path get_cache_file(uint64_t key) {
+            return __cache_folder / std::format("{:016x}.glprog", key);
+        }
+
+        /// a program linked from the cached binary for key, 0 when there is none or the driver refuses it
+        GLuint load_binary(uint64_t key) {
+            const std::filesystem::path cache_file = get_cache_file(key);
+            std::ifstream in(cache_file, std::ios::binary);
+            if (!in) {
+                return 0;
+            }
+
+            program_header header;
+            std::vector<char> binary;
+            if (in.read(reinterpret_cast<char *>(&header), sizeof(header))) {
+                binary.resize(header.binary_size);
+                in.read(binary.data(), binary.size());
+            }
+            if (!in || std::memcmp(header.magic, PROGRAM_MAGIC, sizeof(PROGRAM_MAGIC)) != 0 ||
+                header.version != PROGRAM_CACHE_VERSION || header.key != key) {
+                return 0;
+            }
+            in.close();
+
+            GLuint program = glCreateProgram();
+            glProgramBinary(program, header.binary_format, binary.data(), static_cast<GLsizei>(binary.size()));
+            int success = -1;
+            glGetProgramiv(program, GL_LINK_STATUS, &success);
+            if (GL_TRUE != success) {
+                // a driver update or a different GPU, this binary will never load again
+                glDeleteProgram(program);
+                std::error_code ec;
+                std::filesystem::remove(cache_file, ec);
+                ++__statistics.rejected;
+                return 0;
+            }
+
+            ++__statistics.hits;
+            return program;
+        }
+
+        void store_binary(GLuint program, uint64_t key) {
+            GLint binary_size = 0;
+            glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binary_size);
+            if (binary_size <= 0) {
+                return;
+            }
+
+            program_header header;
+            std::memcpy(header.magic, PROGRAM_MAGIC, sizeof(PROGRAM_MAGIC));
+            header.version = PROGRAM_CACHE_VERSION;
+            header.key = key;
+
+            std::vector<char> binary(binary_size);
+            GLenum binary_format = 0;
+            glGetProgramBinary(program, binary_size, &binary_size, &binary_format, binary.data());
+            header.binary_format = binary_format;
+            header.binary_size = binary_size;
+
+            std::error_code ec;
+            std::filesystem::create_directories(__cache_folder, ec);
+
+            // written aside and renamed so a partly written binary is never loaded
+            const std::filesystem::path cache_file = get_cache_file(key);
+            const std::filesystem::path temp_file = unique_temp_path(cache_file);
+            {
+                std::ofstream out(temp_file, std::ios::binary | std::ios::trunc);
+                if (!out) {
+                    return;
+                }
+                out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+                out.write(binary.data(), header.binary_size);
+                if (!out) {
+                    out.close();
+                    std::filesystem::remove(temp_file, ec);
+                    return;
+                }
+            }
+            std::filesystem::rename(temp_file, cache_file, ec);
+            if (ec) {
+                std::filesystem::remove(temp_file, ec);
+            }
+        }
+
+        /// check the compile and link of program, release its shaders and cache its binary
+        /// @return the info log of a failed compile or link, empty on success
+        std::string finish_link(GLuint program, const pending_program &pending) {
+            char infoLog[512];
+            std::string error;
+
+            int success = -1;
+            glGetShaderiv(pending.vs, GL_COMPILE_STATUS, &success);
+            if (GL_TRUE != success) {
+                glGetShaderInfoLog(pending.vs, 512, nullptr, infoLog);
+                error = std::format("Vertex shader compilation failed:\n{}", infoLog);
+            } else {
+                glGetShaderiv(pending.fs, GL_COMPILE_STATUS, &success);
+                if (GL_TRUE != success) {
+                    glGetShaderInfoLog(pending.fs, 512, nullptr, infoLog);
+                    error = std::format("Fragment shader compilation failed:\n{}", infoLog);
+                }
+            }
+
+            // we can delete the component shaders now we have linked the program
+            glDeleteShader(pending.vs);
+            glDeleteShader(pending.fs);
+            if (!error.empty()) {
+                return error;
+            }
+
+            glGetProgramiv(program, GL_LINK_STATUS, &success);
+            if (GL_TRUE != success) {
+                glGetProgramInfoLog(program, 512, NULL, infoLog);
+                return std::format("Shader link  failed:\n{}", infoLog);
+            }
+
+            if (!__cache_folder.empty()) {
+                store_binary(program, pending.key);
+            }
+            return {};
+        }
+    }
+
+    GLuint link_shader_program(const std::string &vs_source, const std::string &fs_source) {
+        pending_program pending;
+
+        if (!__cache_folder.empty()) {
+            pending.key = hash_bytes(fs_source.data(), fs_source.size(),
+                                     hash_bytes(vs_source.data(), vs_source.size() + 1, driver_hash()));
+            if (GLuint program = load_binary(pending.key); program != 0) {
+                return program;
+            }
+        }
+        ++__statistics.compiles;
+
+        const char *vs_str = vs_source.c_str();
+        const char *fs_str = fs_source.c_str();
+
+        // without parallel compilation each of these blocks, with it they return at once and
+        // the status queries in finish_link are what wait
+        pending.vs = glCreateShader(GL_VERTEX_SHADER);
+        glShaderSource(pending.vs, 1, &vs_str, nullptr);
+        glCompileShader(pending.vs);
+
+        pending.fs = glCreateShader(GL_FRAGMENT_SHADER);
+        glShaderSource(pending.fs, 1, &fs_str, nullptr);
+        glCompileShader(pending.fs);
+
+        GLuint program = glCreateProgram();
+        if (!__cache_folder.empty()) {
+            glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        }
+        glAttachShader(program, pending.vs);
+        glAttachShader(program, pending.fs);
+        glLinkProgram(program);
+
+        if (has_parallel_shader_compile()) {
+            __pending.emplace(program, pending);
+            return program;
+        }
+
+        if (std::string error = finish_link(program, pending); !error.empty()) {
+            glDeleteProgram(program);
+            throw std::runtime_error(error);
+        }
+        return program;
+    }
+
+    bool is_shader_program_ready(GLuint program) {
+        auto found = __pending.find(program);
+        if (found == __pending.end()) {
+            return !__failed.contains(program);
+        }
+
+        GLint complete = GL_FALSE;
+        glGetProgramiv(program, GL_COMPLETION_STATUS_KHR, &complete);
+        if (GL_TRUE != complete) {
+            return false;
+        }
+
+        pending_program pending = found->second;
+        __pending.erase(found);
+        if (std::string error = finish_link(program, pending); !error.empty()) {
+            // called from draw callbacks, so reported rather than thrown. The program is kept, the
+            // shader getters cache its id and a deleted id could be reused by another program
+            XPLMDebugString(std::format("Background shader compile failed, program {} will not draw: {}\n", program, error).c_str());
+            __failed.insert(program);
+            return false;
+        }
+        return true;
+    }
+
+    void set_program_binary_cache(const std::filesystem::path &folder) {
+        __cache_folder = folder;
+    }
+
+    program_cache_statistics get_program_cache_statistics() {
+        return __statistics;
+    }
+}
@@ -0,0 +1,39 @@
+//
+// Created by icarr on 17/10/2026.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <string>
+
+#include <glad/gl.h>
+
+namespace gldraw {
+    /// Compile a vertex and fragment shader pair and link them into a program. With a program binary cache
+    /// set a binary linked by an earlier run is loaded instead. Where the driver compiles in parallel a cold
+    /// compile carries on in the background, check is_shader_program_ready before drawing with it.
+    /// @throws std::runtime_error with the info log if compilation or linking fails
+    GLuint link_shader_program(const std::string &vs_source, const std::string &fs_source);
+
+    /// false while a background compile of program is still running, drawing with it would wait for it.
+    /// Also false for good when the background compile failed, the info log is written to X-Plane's log
+    /// once and the unusable program is kept so the id never names another program.
+    bool is_shader_program_ready(GLuint program);
+
+    /// Keep linked program binaries in folder, keyed by their source and the driver's vendor, renderer and
+    /// version. A binary the driver rejects is compiled from source again. Empty, the default, disables it.
+    void set_program_binary_cache(const std::filesystem::path &folder);
+
+    struct program_cache_statistics {
+        // programs loaded from a binary
+        size_t hits{};
+        // programs compiled from source
+        size_t compiles{};
+        // binaries the driver refused, compiled from source and replaced
+        size_t rejected{};
+    };
+
+    program_cache_statistics get_program_cache_statistics();
+}
@@ -0,0 +1,36 @@
+//
+// Created by icarr on 17/10/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+
+namespace gldraw {
+    /// Optional features of the coloured_vertex shader. Each set flag is compiled in as a #define, so a
+    /// variant only pays for the features it uses and each combination is a program of its own.
+    enum class shader_variant : uint32_t {
+        /// vertex colour only, no texture bound or sampled
+        untextured = 0,
+        /// vertex colour times our_texture
+        textured = 1u << 0,
+        /// discard fragments with alpha under one half, for cut out shapes drawn without sorting
+        alpha_test = 1u << 1,
+        /// multiply the colour by its alpha, for drawing with glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA)
+        premultiplied = 1u << 2,
+        /// coverage from a signed distance field in our_texture's alpha, 0.5 on the edge, for SdfFont glyphs
+        sdf = 1u << 3,
+    };
+
+    /// one past the largest variant, the number of distinct programs
+    constexpr uint32_t SHADER_VARIANT_COUNT = 1u << 4;
+
+    constexpr shader_variant operator|(shader_variant lhs, shader_variant rhs) {
+        return static_cast<shader_variant>(static_cast<uint32_t>(lhs) | static_cast<uint32_t>(rhs));
+    }
+
+    /// true when variant includes every flag of feature
+    constexpr bool has_feature(shader_variant variant, shader_variant feature) {
+        return (static_cast<uint32_t>(variant) & static_cast<uint32_t>(feature)) == static_cast<uint32_t>(feature);
+    }
+}
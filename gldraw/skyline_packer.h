@@ -0,0 +1,138 @@
+//
+// Created by icarr on 17/10/2026.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <optional>
+#include <vector>
+
+namespace gldraw {
+    /// integer rect in texels, origin bottom left
+    struct texel_rect {
+        int x{};
+        int y{};
+        int width{};
+        int height{};
+    };
+
+    /// Bottom left skyline rectangle packer. The packed area is kept as the height of its top edge
+    /// across the width, each rect goes where its top ends up lowest, ties to the narrowest gap.
+    class skyline_packer {
+    public:
+        skyline_packer(int width, int height) : _width(width), _height(height) {
+            _skyline.push_back({0, 0, width});
+        }
+
+        /// place a width x height rect, nullopt when there is no room left for it
+        std::optional<texel_rect> insert(int width, int height) {
+            if (width <= 0 || height <= 0 || width > _width || height > _height) {
+                return std::nullopt;
+            }
+
+            size_t best = _skyline.size();
+            int best_top = std::numeric_limits<int>::max();
+            int best_gap = std::numeric_limits<int>::max();
+            int best_y = 0;
+
+            for (size_t indx = 0; indx < _skyline.size(); ++indx) {
+                std::optional<int> y = fit(indx, width, height);
+                if (!y) {
+                    continue;
+                }
+                const int top = *y + height;
+                const int gap = _skyline[indx].width;
+                if (top < best_top || (top == best_top && gap < best_gap)) {
+                    best = indx;
+                    best_top = top;
+                    best_gap = gap;
+                    best_y = *y;
+                }
+            }
+
+            if (best == _skyline.size()) {
+                return std::nullopt;
+            }
+
+            texel_rect placed{_skyline[best].x, best_y, width, height};
+            add_level(best, placed);
+            _used_area += static_cast<size_t>(width) * height;
+            return placed;
+        }
+
+        /// fraction of the area holding rects
+        [[nodiscard]] float get_occupancy() const {
+            return static_cast<float>(_used_area) / (static_cast<float>(_width) * _height);
+        }
+
+        [[nodiscard]] int get_width() const { return _width; }
+        [[nodiscard]] int get_height() const { return _height; }
+
+    private:
+        /// one step of the skyline, the packed area is y high from x to x + width
+        struct node {
+            int x{};
+            int y{};
+            int width{};
+        };
+
+        /// the y a rect starting at node indx would sit at, resting on the highest node it spans
+        std::optional<int> fit(size_t indx, int width, int height) const {
+            const int x = _skyline[indx].x;
+            if (x + width > _width) {
+                return std::nullopt;
+            }
+
+            int y = 0;
+            int remaining = width;
+            for (size_t span = indx; remaining > 0; ++span) {
+                y = std::max(y, _skyline[span].y);
+                if (y + height > _height) {
+                    return std::nullopt;
+                }
+                remaining -= _skyline[span].width;
+            }
+            return y;
+        }
+
+        /// raise the skyline over placed, trimming the nodes it now covers
+        void add_level(size_t indx, const texel_rect &placed) {
+            _skyline.insert(_skyline.begin() + indx, {placed.x, placed.y + placed.height, placed.width});
+
+            const int right = placed.x + placed.width;
+            for (size_t next = indx + 1; next < _skyline.size();) {
+                node &current = _skyline[next];
+                if (current.x >= right) {
+                    break;
+                }
+                const int shrink = right - current.x;
+                if (current.width <= shrink) {
+                    _skyline.erase(_skyline.begin() + next);
+                    continue;
+                }
+                current.x += shrink;
+                current.width -= shrink;
+                break;
+            }
+
+            // neighbours at the same height are one step
+            for (size_t next = 0; next + 1 < _skyline.size();) {
+                if (_skyline[next].y == _skyline[next + 1].y) {
+                    _skyline[next].width += _skyline[next + 1].width;
+                    _skyline.erase(_skyline.begin() + next + 1);
+                } else {
+                    ++next;
+                }
+            }
+        }
+
+    private:
+        int _width;
+        int _height;
+        std::vector<node> _skyline;
+        size_t _used_area{};
+    };
+}
@@ -0,0 +1,23 @@
+//
+// Created by icarr on 17/10/2026.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <random>
+
+namespace gldraw {
+    /// A name beside file to write it under before renaming it into place. Each call gives a different
+    /// name, so workers or plugin instances writing the same file at once never share a temp file.
+    inline std::filesystem::path unique_temp_path(const std::filesystem::path &file) {
+        // seeded per thread, threads and processes draw independent names
+        thread_local std::mt19937_64 __generator{(static_cast<uint64_t>(std::random_device{}()) << 32) ^ std::random_device{}()};
+
+        std::filesystem::path temp_file = file;
+        temp_file += std::format(".{:016x}.tmp", __generator());
+        return temp_file;
+    }
+}
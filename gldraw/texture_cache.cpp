@@ -0,0 +1,293 @@
+//
+// Created by icarr on 17/10/2026.
+//
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <system_error>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <stb/stb_image.h>
+
+#include <gldraw/temp_file.h>
+
+#include "texture_cache.h"
+
+namespace gldraw {
+    namespace {
+        constexpr char CACHE_MAGIC[8] = {'G', 'L', 'D', 'T', 'E', 'X', '\0', '\0'};
+        constexpr uint32_t CACHE_VERSION = 1;
+
+        /// fixed header of a cache file, followed by the source path, padding to 16 bytes and the levels
+        struct cache_header {
+            char magic[8]{};
+            uint32_t version{};
+            uint32_t level_count{};
+            uint32_t width{};
+            uint32_t height{};
+            uint64_t source_size{};
+            int64_t source_mtime{};
+            uint32_t path_size{};
+            uint32_t reserved{};
+        };
+        static_assert(sizeof(cache_header) == 48);
+
+        size_t levels_offset(uint32_t path_size) {
+            return (sizeof(cache_header) + path_size + 15) & ~size_t(15);
+        }
+
+        /// read only mapping of a whole file, released with the last shared_ptr
+        class mapped_file {
+        public:
+            explicit mapped_file(const std::filesystem::path &filename) {
+#if defined(_WIN32)
+                _file = CreateFileW(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+                if (_file == INVALID_HANDLE_VALUE) {
+                    return;
+                }
+                LARGE_INTEGER size;
+                if (!GetFileSizeEx(_file, &size) || size.QuadPart == 0) {
+                    return;
+                }
+                _mapping = CreateFileMappingW(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                if (_mapping == nullptr) {
+                    return;
+                }
+                _data = static_cast<const unsigned char *>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+                _size = _data != nullptr ? static_cast<size_t>(size.QuadPart) : 0;
+#else
+                int fd = ::open(filename.c_str(), O_RDONLY);
+                if (fd < 0) {
+                    return;
+                }
+                struct stat st{};
+                if (fstat(fd, &st) == 0 && st.st_size > 0) {
+                    void *p_data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                    if (p_data != MAP_FAILED) {
+                        _data = static_cast<const unsigned char *>(p_data);
+                        _size = st.st_size;
+                    }
+                }
+                // the mapping keeps the file alive
+                ::close(fd);
+#endif
+            }
+
+            ~mapped_file() {
+#if defined(_WIN32)
+                if (_data != nullptr) {
+                    UnmapViewOfFile(_data);
+                }
+                if (_mapping != nullptr) {
+                    CloseHandle(_mapping);
+                }
+                if (_file != INVALID_HANDLE_VALUE) {
+                    CloseHandle(_file);
+                }
+#else
+                if (_data != nullptr) {
+                    munmap(const_cast<unsigned char *>(_data), _size);
+                }
+#endif
+            }
+
+            mapped_file(const mapped_file &other) = delete;
+            mapped_file &operator=(const mapped_file &other) = delete;
+
+            [[nodiscard]] const unsigned char *data() const { return _data; }
+            [[nodiscard]] size_t size() const { return _size; }
+
+        private:
+#if defined(_WIN32)
+            HANDLE _file{INVALID_HANDLE_VALUE};
+            HANDLE _mapping{};
+#endif
+            const unsigned char *_data{};
+            size_t _size{};
+        };
+
+        /// point the levels of image at consecutive RGBA8 levels starting at data
+        void lay_out_levels(texture_image &image, const unsigned char *data, uint32_t level_count) {
+            int width = image.width, height = image.height;
+            for (uint32_t level = 0; level < level_count; ++level) {
+                image.levels.push_back({data, width, height});
+                data += image.levels.back().size();
+                width = std::max(1, width / 2);
+                height = std::max(1, height / 2);
+            }
+        }
+
+        size_t chain_size(int width, int height, uint32_t level_count) {
+            size_t size = 0;
+            for (uint32_t level = 0; level < level_count; ++level) {
+                size += static_cast<size_t>(width) * height * 4;
+                width = std::max(1, width / 2);
+                height = std::max(1, height / 2);
+            }
+            return size;
+        }
+
+        uint32_t full_chain_levels(int width, int height) {
+            uint32_t levels = 1;
+            for (int size = std::max(width, height); size > 1; size /= 2) {
+                ++levels;
+            }
+            return levels;
+        }
+
+        /// 2x2 box filter, an odd final row or column is folded into its neighbour by clamping
+        void downsample(const unsigned char *src, int src_width, int src_height, unsigned char *dst, int dst_width, int dst_height) {
+            for (int y = 0; y < dst_height; ++y) {
+                const int y0 = std::min(2 * y, src_height - 1), y1 = std::min(2 * y + 1, src_height - 1);
+                for (int x = 0; x < dst_width; ++x) {
+                    const int x0 = std::min(2 * x, src_width - 1), x1 = std::min(2 * x + 1, src_width - 1);
+                    const unsigned char *p00 = src + 4 * (y0 * src_width + x0), *p01 = src + 4 * (y0 * src_width + x1);
+                    const unsigned char *p10 = src + 4 * (y1 * src_width + x0), *p11 = src + 4 * (y1 * src_width + x1);
+                    for (int channel = 0; channel < 4; ++channel) {
+                        dst[4 * (y * dst_width + x) + channel] =
+                                static_cast<unsigned char>((p00[channel] + p01[channel] + p10[channel] + p11[channel] + 2) / 4);
+                    }
+                }
+            }
+        }
+
+        texture_image try_load_cache(const std::filesystem::path &cache_file, const std::string &source,
+                                     uint64_t source_size, int64_t source_mtime) {
+            texture_image image;
+
+            auto mapping = std::make_shared<mapped_file>(cache_file);
+            if (mapping->data() == nullptr || mapping->size() < sizeof(cache_header)) {
+                return image;
+            }
+
+            cache_header header;
+            std::memcpy(&header, mapping->data(), sizeof(header));
+            if (std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || header.version != CACHE_VERSION ||
+                header.source_size != source_size || header.source_mtime != source_mtime ||
+                header.width == 0 || header.height == 0 || header.level_count == 0 || header.level_count > 32 ||
+                sizeof(cache_header) + header.path_size > mapping->size() ||
+                std::string_view(reinterpret_cast<const char *>(mapping->data() + sizeof(cache_header)), header.path_size) != source) {
+                return image;
+            }
+
+            const size_t offset = levels_offset(header.path_size);
+            image.width = static_cast<int>(header.width);
+            image.height = static_cast<int>(header.height);
+            if (offset + chain_size(image.width, image.height, header.level_count) > mapping->size()) {
+                // truncated
+                image.width = image.height = 0;
+                return image;
+            }
+
+            lay_out_levels(image, mapping->data() + offset, header.level_count);
+            image.storage = std::move(mapping);
+            image.from_cache = true;
+            return image;
+        }
+
+        void write_cache(const std::filesystem::path &cache_file, const std::string &source, uint64_t source_size,
+                         int64_t source_mtime, const texture_image &image) {
+            cache_header header;
+            std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+            header.version = CACHE_VERSION;
+            header.level_count = image.levels.size();
+            header.width = image.width;
+            header.height = image.height;
+            header.source_size = source_size;
+            header.source_mtime = source_mtime;
+            header.path_size = source.size();
+
+            // written aside and renamed so a reader never maps half a file
+            const std::filesystem::path temp_file = unique_temp_path(cache_file);
+            {
+                std::ofstream out(temp_file, std::ios::binary | std::ios::trunc);
+                if (!out) {
+                    return;
+                }
+                out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+                out.write(source.data(), source.size());
+                const char padding[16]{};
+                out.write(padding, levels_offset(header.path_size) - sizeof(header) - source.size());
+                for (const texture_level &level: image.levels) {
+                    out.write(reinterpret_cast<const char *>(level.data), level.size());
+                }
+                if (!out) {
+                    out.close();
+                    std::error_code ec;
+                    std::filesystem::remove(temp_file, ec);
+                    return;
+                }
+            }
+
+            // a read only folder or a cache mapped by another load just means no cache this time
+            std::error_code ec;
+            std::filesystem::rename(temp_file, cache_file, ec);
+            if (ec) {
+                std::filesystem::remove(temp_file, ec);
+            }
+        }
+    }
+
+    std::filesystem::path get_texture_cache_path(const std::filesystem::path &image_filename) {
+        std::filesystem::path cache_file = image_filename;
+        cache_file += ".gltex";
+        return cache_file;
+    }
+
+    texture_image load_texture_image(const std::filesystem::path &image_filename) {
+        std::error_code ec;
+        const uint64_t source_size = std::filesystem::file_size(image_filename, ec);
+        if (ec) {
+            texture_image image;
+            image.error = ec.message();
+            return image;
+        }
+        const int64_t source_mtime = std::filesystem::last_write_time(image_filename, ec).time_since_epoch().count();
+        const std::string source = image_filename.generic_string();
+        const std::filesystem::path cache_file = get_texture_cache_path(image_filename);
+
+        texture_image image = try_load_cache(cache_file, source, source_size, source_mtime);
+        if (!image.levels.empty()) {
+            return image;
+        }
+
+        // decode, bottom row first as GL expects, the setting is per thread so workers may call this
+        stbi_set_flip_vertically_on_load_thread(true);
+        int width, height, channels;
+        std::unique_ptr<unsigned char, decltype(&stbi_image_free)> pixels(
+                stbi_load(image_filename.string().c_str(), &width, &height, &channels, 4), &stbi_image_free);
+        if (!pixels) {
+            image.error = stbi_failure_reason();
+            return image;
+        }
+
+        // the whole chain in one block, level 0 first
+        const uint32_t level_count = full_chain_levels(width, height);
+        auto chain = std::make_shared<std::vector<unsigned char>>(chain_size(width, height, level_count));
+        std::memcpy(chain->data(), pixels.get(), static_cast<size_t>(width) * height * 4);
+        pixels.reset();
+
+        image.width = width;
+        image.height = height;
+        lay_out_levels(image, chain->data(), level_count);
+        for (uint32_t level = 1; level < level_count; ++level) {
+            const texture_level &src = image.levels[level - 1];
+            const texture_level &dst = image.levels[level];
+            downsample(src.data, src.width, src.height, const_cast<unsigned char *>(dst.data), dst.width, dst.height);
+        }
+        image.storage = std::move(chain);
+
+        write_cache(cache_file, source, source_size, source_mtime, image);
+        return image;
+    }
+}
@@ -0,0 +1,43 @@
+//
+// Created by icarr on 17/10/2026.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace gldraw {
+    /// one level of an RGBA8 mip chain, rows bottom up as GL expects
+    struct texture_level {
+        const unsigned char *data{};
+        int width{};
+        int height{};
+
+        [[nodiscard]] size_t size() const { return static_cast<size_t>(width) * height * 4; }
+    };
+
+    /// an RGBA8 image with its full mip chain, the levels point into storage
+    struct texture_image {
+        int width{};
+        int height{};
+        std::vector<texture_level> levels;
+        // a mapping of the cache file or the decoded pixels
+        std::shared_ptr<const void> storage;
+        /// why levels is empty
+        std::string error;
+        /// true when read from the cache rather than decoded
+        bool from_cache{};
+    };
+
+    /// the cache file kept beside an image
+    std::filesystem::path get_texture_cache_path(const std::filesystem::path &image_filename);
+
+    /// Load image_filename as RGBA8 with a full mip chain. The cache file beside it is memory mapped when
+    /// it matches the image's path, size and modification time, otherwise the image is decoded, the mips
+    /// built and the cache rewritten. Safe to call from worker threads.
+    texture_image load_texture_image(const std::filesystem::path &image_filename);
+}
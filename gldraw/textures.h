@@ -8,6 +8,8 @@
 #include <glad/gl.h>
 #include <stb/stb_image.h>
 
+#include <gldraw/texture_cache.h>
+
 namespace gldraw {
     static void create_and_bind_texture(GLuint *texture_id) {
         if (texture_id != nullptr) {
@@ -35,24 +37,18 @@ namespace gldraw {
         // set the maximum!
         glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY, max_aniso);
 
-        // load image, create texture and generate mipmaps
-        int width, height, nrChannels;
-        stbi_set_flip_vertically_on_load(true); // tell stb_image.h to flip loaded texture's on the y-axis.
-        unsigned char *data = stbi_load(image_filename.c_str(), &width, &height, &nrChannels, 0);
-        if (data) {
-#if defined (DSA)
-            glTextureStorage2D(texture_id, 1, GL_RGBA, width, height);
-            glTextureSubImage2D(texture_id, 1, 0,0, width, height, nrChannels == 3 ? GL_RGB : GL_RGBA, GL_UNSIGNED_BYTE, data);
-            glGenerateTextureMipmap(texture_id);
-#else
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, nrChannels == 3 ? GL_RGB : GL_RGBA, GL_UNSIGNED_BYTE, data);
-            glGenerateMipmap(GL_TEXTURE_2D);
-#endif
+        // load the image with its mipmaps, from the pre-decoded cache beside it when that is current
+        texture_image image = load_texture_image(image_filename);
+        if (!image.levels.empty()) {
+            glTexStorage2D(GL_TEXTURE_2D, image.levels.size(), GL_RGBA8, image.width, image.height);
+            for (size_t level = 0; level < image.levels.size(); ++level) {
+                const texture_level &mip = image.levels[level];
+                glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, mip.width, mip.height, GL_RGBA, GL_UNSIGNED_BYTE, mip.data);
+            }
         } else {
-            XPLMDebugString(std::format("Failed to load texture: {}\n", stbi_failure_reason()).c_str());
+            XPLMDebugString(std::format("Failed to load texture: {}\n", image.error).c_str());
         }
-        // data has been transferred to the GPU we can loose it locally!
-        stbi_image_free(data);
+        // the mapping or decoded pixels are released with image
 
         return texture_id;
     }
@@ -0,0 +1,60 @@
+//
+// Created by icarr on 17/10/2026.
+//
+
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+
+#include <glad/gl.h>
+
+namespace gldraw {
+    /// one shader input of a vertex type, passed to glVertexArrayAttribFormat
+    struct vertex_attribute {
+        GLuint location{};
+        GLint components{};
+        GLenum type{};
+        GLboolean normalized{};
+        GLuint offset{};
+        // read by a uint or int shader input through glVertexArrayAttribIFormat, never converted to float
+        bool integer{};
+    };
+
+    /// a vertex or per instance type describing its attributes with a constexpr array, e.g.
+    ///     static constexpr std::array<vertex_attribute, 2> attributes{{
+    ///         {0, 2, GL_FLOAT, GL_FALSE, offsetof(my_vertex, position)}, ... }};
+    template<typename TVertex>
+    concept vertex_layout = requires {
+        { TVertex::attributes.size() } -> std::convertible_to<size_t>;
+        { TVertex::attributes[0] } -> std::convertible_to<vertex_attribute>;
+    };
+
+    /// configure the attribute formats of vao once, the attributes read from buffer binding index binding
+    template<vertex_layout TVertex>
+    void configure_vertex_array(GLuint vao, GLuint binding = 0) {
+        for (const vertex_attribute &attribute: TVertex::attributes) {
+            glEnableVertexArrayAttrib(vao, attribute.location);
+            if (attribute.integer) {
+                glVertexArrayAttribIFormat(vao, attribute.location, attribute.components, attribute.type, attribute.offset);
+            } else {
+                glVertexArrayAttribFormat(vao, attribute.location, attribute.components, attribute.type,
+                                          attribute.normalized, attribute.offset);
+            }
+            glVertexArrayAttribBinding(vao, attribute.location, binding);
+        }
+    }
+
+    /// as configure_vertex_array for a buffer holding one TInstance per instance rather than per vertex
+    template<vertex_layout TInstance>
+    void configure_instance_array(GLuint vao, GLuint binding = 0) {
+        configure_vertex_array<TInstance>(vao, binding);
+        glVertexArrayBindingDivisor(vao, binding, 1);
+    }
+
+    /// attach vbo to binding of vao, only needed when the buffer name changes, also for instance buffers
+    template<vertex_layout TVertex>
+    void bind_vertex_buffer(GLuint vao, GLuint vbo, GLuint binding = 0) {
+        glVertexArrayVertexBuffer(vao, binding, vbo, 0, sizeof(TVertex));
+    }
+}
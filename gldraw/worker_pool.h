@@ -0,0 +1,90 @@
+//
+// Created by icarr on 17/10/2026.
+//
+
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace gldraw {
+    /// fixed set of threads running submitted jobs in order, for CPU only work (no GL calls)
+    class worker_pool {
+    public:
+        /// @param thread_count 0 picks one less than the hardware threads, leaving one for the sim, and at
+        /// least one when the hardware count is unknown
+        explicit worker_pool(unsigned int thread_count = 0) {
+            if (thread_count == 0) {
+                thread_count = std::max(2u, std::thread::hardware_concurrency()) - 1;
+            }
+            _threads.reserve(thread_count);
+            for (unsigned int indx = 0; indx < thread_count; ++indx) {
+                _threads.emplace_back([this] { run(); });
+            }
+        }
+
+        /// finishes the queued jobs then joins the threads
+        ~worker_pool() {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stopping = true;
+            }
+            _wake.notify_all();
+            for (std::thread &thread: _threads) {
+                thread.join();
+            }
+        }
+
+        worker_pool(const worker_pool &other) = delete;
+        worker_pool &operator=(const worker_pool &other) = delete;
+
+    public:
+        [[nodiscard]] size_t get_thread_count() const { return _threads.size(); }
+
+        /// queue job, the future carries its result or exception
+        template<typename TJob>
+        std::future<std::invoke_result_t<TJob>> submit(TJob &&job) {
+            // std::function needs a copyable target, share the move only task
+            auto task = std::make_shared<std::packaged_task<std::invoke_result_t<TJob>()>>(std::forward<TJob>(job));
+            std::future<std::invoke_result_t<TJob>> result = task->get_future();
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _jobs.emplace_back([task] { (*task)(); });
+            }
+            _wake.notify_one();
+            return result;
+        }
+
+    private:
+        void run() {
+            while (true) {
+                std::function<void()> job;
+                {
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    _wake.wait(lock, [this] { return _stopping || !_jobs.empty(); });
+                    if (_jobs.empty()) {
+                        return;
+                    }
+                    job = std::move(_jobs.front());
+                    _jobs.pop_front();
+                }
+                job();
+            }
+        }
+
+    private:
+        std::vector<std::thread> _threads;
+        std::deque<std::function<void()>> _jobs;
+        std::mutex _mutex;
+        std::condition_variable _wake;
+        bool _stopping{};
+    };
+}
@@ -3,8 +3,13 @@
 //
 
 #include <stdio.h>
+#include <cstring>
 #include <string>
 #include <filesystem>
+#include <algorithm>
+#include <vector>
+#include <cmath>
+#include <numbers>
 
 #define GLAD_GL_IMPLEMENTATION
 #include <glad/gl.h>
@@ -14,16 +19,70 @@
 #include <XPLMDisplay.h>
 #include <XPLMUtilities.h>
 #include <XPLMPlanes.h>
+#include <XPLMProcessing.h>
+#include <XPLMPlugin.h>
 
 #include <glmath/projections.h>
 #include <glmath/matrices.h>
 
 #include <gldraw/shaders/coloured_vertex.h>
+#include <gldraw/shaders/instanced_quad.h>
+#include <gldraw/shaders/shader_program.h>
 #include <gldraw/VertexManager.h>
+#include <gldraw/InstancedQuadManager.h>
+#include <gldraw/BufferValidator.h>
+#include <gldraw/RenderState.h>
+#include <gldraw/OffscreenCache.h>
+#include <gldraw/RefreshScheduler.h>
+#include <gldraw/ResourceIndex.h>
+#include <gldraw/frame_arena.h>
+#include <gldraw/GeometryPipeline.h>
+#include <gldraw/worker_pool.h>
 #include <gldraw/textures.h>
+#include <gldraw/TextureLoader.h>
+#include <gldraw/BindlessTextures.h>
+#include <gldraw/SdfFont.h>
+#include <gldraw/TextLayoutCache.h>
+#include <gldraw/shaders/sdf_primitive.h>
+#include <gldraw/SdfPrimitiveManager.h>
 
 #define PER_FRAME_GEOM
 #define USE_STATIC_BUFFERS_ONLY
+// stream per frame geometry through a persistently mapped ring, overrides USE_STATIC_BUFFERS_ONLY
+//#define USE_PERSISTENT_RING_BUFFERS
+// draw the test quad through the instanced quad renderer instead of the vertex manager
+//#define USE_INSTANCED_QUADS
+// keep the test quad in the vertex manager and move it in place instead of rebuilding every frame
+//#define USE_RETAINED_QUADS
+// build each display's per frame geometry on worker threads a frame ahead, the GL thread only uploads and draws
+#define USE_GEOMETRY_PIPELINE
+// render each distinct scene and size once per sim frame into a texture and composite it on every display showing it
+#define USE_OFFSCREEN_CACHE
+// re-render each display at its own refresh rate, throttled to a per frame budget, compositing the cache in between
+#define USE_REFRESH_SCHEDULER
+// decode textures on the workers and upload them in slices, showing white until they arrive
+#define USE_ASYNC_TEXTURES
+// sample textures through resident GL_ARB_bindless_texture handles, binding them where the extension is missing
+#define USE_BINDLESS_TEXTURES
+// name each display in signed distance field text
+#define USE_TEXT_LABELS
+// overlay a compass rose drawn from analytic signed distance primitives, one quad each
+#define USE_SDF_PRIMITIVES
+
+#if defined(USE_REFRESH_SCHEDULER) && !defined(USE_OFFSCREEN_CACHE)
+// displays skipping a render need the offscreen cache to composite
+#undef USE_REFRESH_SCHEDULER
+#endif
+
+#if defined(USE_BINDLESS_TEXTURES) && defined(USE_INSTANCED_QUADS)
+// the instanced quad shader has no bindless variant
+#undef USE_BINDLESS_TEXTURES
+#endif
+
+#if defined(USE_GEOMETRY_PIPELINE) && (!defined(PER_FRAME_GEOM) || defined(USE_PERSISTENT_RING_BUFFERS) || defined(USE_INSTANCED_QUADS))
+// only staged per frame vertex manager geometry can be built off the GL thread
+#undef USE_GEOMETRY_PIPELINE
+#endif
 
 static XPLMAvionicsID __avionics_callback_id_pfd1;
 static XPLMAvionicsID __avionics_callback_id_pfd2;
@@ -31,10 +90,79 @@ static XPLMAvionicsID __avionics_callback_id_mfd;
 
 static int __avionics_count;
 
+// the sim frame of the last do_render, work done once a frame happens when it changes
+static int _render_cycle_ = -1;
+
+// geometry building and texture decoding, one thread per display is plenty
+static std::unique_ptr<gldraw::worker_pool> _workers_;
+
+#if defined USE_ASYNC_TEXTURES
+static std::unique_ptr<gldraw::TextureLoader> _texture_loader_;
+static gldraw::texture_handle _grid_texture_;
+// upload time per sim frame for textures still loading
+constexpr double TEXTURE_UPLOAD_BUDGET_MS = 1.0;
+#else
 static GLuint _grid_texture_id_;
+#endif
+
+#if defined USE_BINDLESS_TEXTURES
+// null when the driver lacks GL_ARB_bindless_texture
+static std::unique_ptr<gldraw::BindlessTextures> _bindless_textures_;
+#endif
+
+#if defined USE_TEXT_LABELS
+constexpr float LABEL_PIXEL_SIZE = 24.0f;
+static std::unique_ptr<gldraw::SdfFont> _label_font_;
+static std::unique_ptr<gldraw::TextLayoutCache> _text_layouts_;
+static std::unique_ptr<gldraw::VertexManager<gldraw::coloured_vertex>> _text_vmgr_;
+#endif
+
+#if defined USE_SDF_PRIMITIVES
+static std::unique_ptr<gldraw::SdfPrimitiveManager> _sdf_primitives_;
+#endif
+
+#if defined PER_FRAME_GEOM
+// per frame geometry staging, declared before the managers using it so it is destroyed after them
+static gldraw::frame_arena _frame_arena_(64 * 1024);
+#endif
+
 static std::unique_ptr<gldraw::VertexManager<gldraw::coloured_vertex>> _vmgr_;
+static std::unique_ptr<gldraw::InstancedQuadManager> _iqmgr_;
+static gldraw::quad_handle _test_quad_;
+
+/// a surface drawn by do_render, passed as the refcon of its avionics device or window
+struct display_target {
+    const char *name;
+    // displays showing the same scene at the same size share an offscreen render
+    const char *scene;
+    // re-renders per second, 0 for every sim frame
+    float refresh_hz;
+#if defined USE_GEOMETRY_PIPELINE
+    std::unique_ptr<gldraw::GeometryPipeline<gldraw::coloured_vertex>> pipeline;
+#endif
+};
+
+static display_target _pfd1_display_{"PFD1", "test quad", 0.0f};
+static display_target _pfd2_display_{"PFD2", "test quad", 0.0f};
+static display_target _mfd_display_{"MFD", "test quad", 20.0f};
+static display_target _window_display_{"Test Window", "test quad", 10.0f};
+
+#if defined USE_OFFSCREEN_CACHE
+static std::unique_ptr<gldraw::OffscreenCache> _offscreen_cache_;
+// draws the cached texture onto the display
+static std::unique_ptr<gldraw::VertexManager<gldraw::coloured_vertex>> _composite_vmgr_;
+static gldraw::quad_handle _composite_quad_;
+#endif
+
+#if defined USE_REFRESH_SCHEDULER
+// the render time per sim frame the displays share
+constexpr double RENDER_BUDGET_MS = 2.0;
+static std::unique_ptr<gldraw::RefreshScheduler> _refresh_scheduler_;
+#endif
 
 static bool _buffers_generated_ = false;
+static std::unique_ptr<gldraw::BufferValidator> _buffer_validator_;
+static gldraw::RenderState _render_state_;
 
 #if defined(GLAD_OPTION_GL_DEBUG)
 static void pre_call_gl_callback(const char *name, GLADapiproc apiproc, int len_args, ...) {
@@ -74,123 +202,410 @@ MessageCallback(GLenum source, GLenum type, GLuint id, GLenum severity,
 }
 #endif
 
+/// the folder holding this plugin, above the platform folder the xpl is loaded from
+static std::filesystem::path get_plugin_folder() {
+    char xp_path[512];
+    XPLMGetPluginInfo(XPLMGetMyID(), nullptr, xp_path, nullptr, nullptr);
+
+    std::filesystem::path folder = std::filesystem::path(xp_path).parent_path();
+    const std::string platform = folder.filename().string();
+    if (platform == "64" || platform == "32" || platform == "win_x64" || platform == "mac_x64" || platform == "lin_x64") {
+        folder = folder.parent_path();
+    }
+    return folder;
+}
+
+/// the X-Plane installation folder
+static std::filesystem::path get_xp_system_folder() {
+    char xp_path[512];
+    XPLMGetSystemPath(xp_path);
+    return std::filesystem::path(xp_path);
+}
+
+/// index of the xp Resources folder, persisted in the xp caches folder and refreshed on first use
+static const gldraw::ResourceIndex &get_xp_resources_index() {
+    static std::unique_ptr<gldraw::ResourceIndex> __index;
+
+    if (!__index) {
+        std::filesystem::path system_folder = get_xp_system_folder();
+
+        __index = std::make_unique<gldraw::ResourceIndex>(system_folder / "Resources",
+                                                          system_folder / "Output" / "caches" / "minimal_plugin_resources.idx");
+        __index->refresh();
+
+        gldraw::ResourceIndex::statistics stats = __index->get_statistics();
+        XPLMDebugString(std::format("resource index: {} files in {} folders, {} folders listed{}\n",
+                                    stats.file_count, stats.directory_count, stats.listed_count,
+                                    stats.saved ? "" : ", cache not saved").c_str());
+    }
+    return *__index;
+}
+
+/// index of the plugin folder, small enough not to need a cache file
+static const gldraw::ResourceIndex &get_plugin_index() {
+    static std::unique_ptr<gldraw::ResourceIndex> __index;
+
+    if (!__index) {
+        __index = std::make_unique<gldraw::ResourceIndex>(get_plugin_folder());
+        __index->refresh(1);
+    }
+    return *__index;
+}
+
 static std::string resolve_resource(const std::string_view &resource_name) {
     char xp_filename[256];
     char xp_path[512];
 
-    // search the aircraft folder first
+    // search the aircraft folder first, only its top level
     XPLMGetNthAircraftModel(XPLM_USER_AIRCRAFT, xp_filename, xp_path);
 
     std::filesystem::path aircraft_file(xp_path);
 
     if (std::filesystem::exists(aircraft_file)) {
-        std::filesystem::path aircraft_folder = aircraft_file.parent_path();
-        if (std::filesystem::exists(aircraft_folder)) {
-            for (const auto &file: std::filesystem::directory_iterator(aircraft_folder)) {
-                if (file.path().filename().string() == resource_name) {
-                    return file.path().string();
-                }
-            }
+        std::filesystem::path aircraft_resource = aircraft_file.parent_path() / resource_name;
+        if (std::filesystem::is_regular_file(aircraft_resource)) {
+            return aircraft_resource.string();
         }
     }
 
     // then search the xp resources
-    XPLMGetSystemPath(xp_path);
-    std::filesystem::path system_folder(xp_path);
-    if (std::filesystem::exists(aircraft_file)) {
-        std::filesystem::path resources_folder = system_folder / "Resources";
-        if (std::filesystem::exists(aircraft_file)) {
-            for (const auto &file: std::filesystem::recursive_directory_iterator(resources_folder)) {
-                if (file.path().filename().string() == resource_name) {
-                    return file.path().string();
-                }
-            }
-        }
+    if (std::optional<std::filesystem::path> resource = get_xp_resources_index().find(resource_name)) {
+        return resource->string();
     }
 
     // then search the plugin folder
+    if (std::optional<std::filesystem::path> resource = get_plugin_index().find(resource_name)) {
+        return resource->string();
+    }
 
     // resource not found
-    throw std::runtime_error(std::format("Resource {} not found in aircraft or Resources folder", resource_name));
+    throw std::runtime_error(std::format("Resource {} not found in aircraft, Resources or plugin folder", resource_name));
 }
 
-void do_render(const gldraw::rect &rct) {
-    // grab the current winding order
-    GLint front_face;
-    glGetIntegerv(GL_FRONT_FACE, &front_face);
+/// the programs this configuration draws with
+static std::vector<GLuint> get_scene_shaders() {
+    std::vector<GLuint> shaders;
+#if defined USE_INSTANCED_QUADS
+    shaders.push_back(gldraw::get_instanced_quad_shader());
+#endif
+#if defined USE_BINDLESS_TEXTURES
+    if (_bindless_textures_) {
+        shaders.push_back(gldraw::get_bindless_coloured_vertex_shader());
+    }
+#endif
+    // drawn with directly or used to composite the offscreen cache
+    shaders.push_back(gldraw::get_coloured_vertex_shader());
+#if defined USE_OFFSCREEN_CACHE
+    if (_composite_vmgr_) {
+        shaders.push_back(gldraw::get_coloured_vertex_shader(_composite_vmgr_->get_shader_variant()));
+    }
+#endif
+#if defined USE_TEXT_LABELS
+    if (_text_vmgr_) {
+        shaders.push_back(gldraw::get_coloured_vertex_shader(_text_vmgr_->get_shader_variant()));
+    }
+#endif
+#if defined USE_SDF_PRIMITIVES
+    shaders.push_back(gldraw::get_sdf_primitive_shader());
+#endif
+    return shaders;
+}
+
+/// false while a program is still compiling, the displays skip drawing rather than stall the sim.
+/// A program that failed to build leaves the displays blank, it is logged once and not retried
+static bool shaders_ready() {
+    static bool __ready = false;
+    static bool __failed = false;
+
+    if (!__ready && !__failed) {
+        try {
+            __ready = std::ranges::all_of(get_scene_shaders(), gldraw::is_shader_program_ready);
+        } catch (const std::exception &ex) {
+            // compiled without parallel compilation, exceptions must not escape the draw callbacks
+            XPLMDebugString(std::format("shader build failed, displays disabled: {}\n", ex.what()).c_str());
+            __failed = true;
+        }
+    }
+    return __ready;
+}
+
+/// set up the state shared by every pass drawing with shader, finish with _render_state_.end_pass()
+static void begin_render_pass(GLuint shader) {
+    // the winding order and blend function are grabbed from X-Plane, end_pass puts them back
+    _render_state_.begin_pass();
 
 #if defined CCW_WINDING
     // set the winding order to OpenGL standard
-    glFrontFace(GL_CCW);
-
-    // check the new front_face setting is applied
-    GLint front_face1;
-    glGetIntegerv(GL_FRONT_FACE, &front_face1);
+    _render_state_.set_front_face(GL_CCW);
 #endif
 
     XPLMSetGraphicsState(0/*GL_FOG*/, 1/*GL_TEXTURE_2D*/, 0/*GL_LIGHT0*/, 0/*GL_ALPHA_TEST*/, 1/*GL_BLEND*/, 0/*GL_DEPTH_TEST*/, 0/*glDepthMask(GL_TRUE)*/);
 
-    // render the content
-
-    // the shader program
-    GLuint g1000_shader = gldraw::get_coloured_vertex_shader();
-    glUseProgram(g1000_shader);
-    glUniform1i(glGetUniformLocation(g1000_shader, "our_texture"), 0);
+    _render_state_.use_program(shader);
+    // uniforms keep their values in the program, these only reach GL when they change
+    _render_state_.set_uniform("our_texture", 0);
 
-    // orthographic pixel projection
+    // orthographic pixel projection, the viewport is X-Plane's per device so it is still queried
     GLint vp[4];
     glGetIntegerv(GL_VIEWPORT, vp);
     // an ortho projection
     glmath::mat4x4 fb_projection = glmath::ortho(vp[0], vp[0]+vp[2], vp[1], vp[1]+vp[3]);
 
     // set the projection matrix for the shader
-    glUniformMatrix4fv(glGetUniformLocation(g1000_shader, "projection"), 1, GL_FALSE, fb_projection.as_pointer_to_float());
+    _render_state_.set_uniform("projection", fb_projection);
 
     // setup the object transform
     glmath::mat4x4 model_mat = glmath::mat4x4::identity;
 
     // store the model transform to the shader
-    glUniformMatrix4fv(glGetUniformLocation(g1000_shader, "model"), 1, GL_FALSE, model_mat.as_pointer_to_float());
+    _render_state_.set_uniform("model", model_mat);
+}
 
-    // render the vertex manager content
+/// draw the scene of display filling rct
+static void render_scene(const gldraw::rect &rct, display_target &display) {
+    // the shader program
+#if defined USE_ASYNC_TEXTURES
+    GLuint grid_texture = _grid_texture_.get();
+#else
+    GLuint grid_texture = _grid_texture_id_;
+#endif
+
+#if defined USE_BINDLESS_TEXTURES
+    if (_bindless_textures_) {
+        // the texture is picked by its handle table entry, nothing is bound
+        begin_render_pass(gldraw::get_bindless_coloured_vertex_shader());
+        _render_state_.set_uniform("texture_index", static_cast<GLint>(_bindless_textures_->add(grid_texture)));
+        _bindless_textures_->bind();
+    } else
+#endif
+    {
+#if defined USE_INSTANCED_QUADS
+        GLuint g1000_shader = gldraw::get_instanced_quad_shader();
+#else
+        GLuint g1000_shader = gldraw::get_coloured_vertex_shader();
+#endif
+        begin_render_pass(g1000_shader);
+
+        // bind textures on corresponding texture units
+        XPLMBindTexture2d(grid_texture, 0);
+    }
 
-    // bind textures on corresponding texture units
-    XPLMBindTexture2d(_grid_texture_id_, 0);
+    // render the vertex manager content
 
     // render the rectangle
-    if (_vmgr_) {
+    gldraw::VertexManager<gldraw::coloured_vertex> *vmgr = nullptr;
+#if defined USE_INSTANCED_QUADS
+    if (_iqmgr_) {
 #if defined PER_FRAME_GEOM
-        _vmgr_->clear();
-        _vmgr_->add_quad(rct);
-        _vmgr_->gen_buffers();
+        _iqmgr_->clear();
+        _iqmgr_->add_quad(rct);
+        _iqmgr_->gen_buffers();
 #else
         if (!_buffers_generated_) {
-                _vmgr_->gen_buffers();
+            _iqmgr_->gen_buffers();
+            _buffers_generated_ = true;
+        }
+#endif
+        _iqmgr_->draw();
+    }
+#elif defined USE_GEOMETRY_PIPELINE
+    if (display.pipeline) {
+        // upload the geometry built during the previous frame and start on the next, the builder
+        // runs on a worker so it captures the rectangle by value
+        vmgr = &display.pipeline->next_frame([rct](gldraw::VertexManager<gldraw::coloured_vertex> &geometry) {
+            geometry.clear();
+            geometry.add_quad(rct);
+        });
+        vmgr->draw();
+    }
+#else
+    vmgr = _vmgr_.get();
+    if (vmgr) {
+#if defined(PER_FRAME_GEOM) && defined(USE_RETAINED_QUADS) && !defined(USE_PERSISTENT_RING_BUFFERS)
+        // only the test quad's vertices are uploaded
+        vmgr->update_quad(_test_quad_, rct);
+        vmgr->gen_buffers();
+#elif defined PER_FRAME_GEOM
+        vmgr->clear();
+        vmgr->add_quad(rct);
+        vmgr->gen_buffers();
+#else
+        if (!_buffers_generated_) {
+                vmgr->gen_buffers();
                 _buffers_generated_ = true;
             }
 #endif
-        glBindVertexArray(_vmgr_->get_vao());
-        glDrawElements(GL_TRIANGLES, _vmgr_->get_element_count(), GL_UNSIGNED_INT, 0);
+        vmgr->draw();
     }
+#endif
     glBindVertexArray(0);
 
-#if defined CCW_WINDING
-    // set the winding order back to stored value
-    glFrontFace(front_face);
+    // set the winding order back to X-Plane's
+    _render_state_.end_pass();
+
+    if (vmgr && _buffer_validator_) {
+        // queue a check of this frame's buffers and report any earlier checks that have completed
+        vmgr->validate_buffers(*_buffer_validator_, display.name);
+        _buffer_validator_->poll([](const std::string &label) {
+            XPLMDebugString(std::format("Buffers corrupted after render: {}\n", label).c_str());
+        });
+    }
+}
+
+#if defined USE_OFFSCREEN_CACHE
+/// draw a texture rendered by the offscreen cache filling rct
+static void composite_texture(GLuint texture, const gldraw::rect &rct) {
+    // the composite quad records the shader features it needs, the cached content is already premultiplied
+    begin_render_pass(gldraw::get_coloured_vertex_shader(_composite_vmgr_->get_shader_variant()));
+
+    XPLMBindTexture2d(texture, 0);
+
+    _composite_vmgr_->update_quad(_composite_quad_, rct);
+    _composite_vmgr_->gen_buffers();
+
+    // the cached content has premultiplied alpha, end_pass puts X-Plane's blend function back
+    _render_state_.set_blend_func(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    _composite_vmgr_->draw();
+
+    glBindVertexArray(0);
+    _render_state_.end_pass();
+}
+#endif
+
+#if defined USE_TEXT_LABELS
+/// write the display's name in the bottom left of rct, after any compositing as displays share renders
+static void draw_label(const gldraw::rect &rct, const display_target &display) {
+    if (!_label_font_ || !_text_vmgr_) {
+        return;
+    }
+
+    begin_render_pass(gldraw::get_coloured_vertex_shader(_text_vmgr_->get_shader_variant()));
+    XPLMBindTexture2d(_label_font_->get_texture(), 0);
+
+    // the layout is cached, only the quads are rebuilt
+    _text_vmgr_->clear();
+    _text_layouts_->add_text(*_text_vmgr_, *_label_font_, display.name,
+                             rct.pos + glmath::vec2f(16.0f, 16.0f), LABEL_PIXEL_SIZE, gldraw::COL_YELLOW);
+    _text_vmgr_->gen_buffers();
+    _text_vmgr_->draw();
+
+    glBindVertexArray(0);
+    _render_state_.end_pass();
+}
+#endif
+
+#if defined USE_SDF_PRIMITIVES
+/// a compass rose in the top right of rct, each ring, arc and tick is a single quad
+static void draw_compass(const gldraw::rect &rct, int cycle) {
+    if (!_sdf_primitives_) {
+        return;
+    }
+
+    begin_render_pass(gldraw::get_sdf_primitive_shader());
+
+    constexpr float radius = 96.0f;
+    const glmath::vec2f centre = rct.pos + rct.size - glmath::vec2f(radius + 24.0f, radius + 24.0f);
+    const float pi = std::numbers::pi_v<float>;
+
+    _sdf_primitives_->clear();
+    _sdf_primitives_->add_rounded_rect({centre - glmath::vec2f(radius + 12.0f, radius + 12.0f),
+                                        {2.0f * radius + 24.0f, 2.0f * radius + 24.0f}}, 12.0f, {0, 0, 0, 160});
+    _sdf_primitives_->add_ring(centre, radius, 2.0f, gldraw::COL_WHITE);
+    // a tick every 30 degrees, longer at the cardinal points
+    for (int tick = 0; tick < 12; ++tick) {
+        const float angle = tick * pi / 6.0f;
+        const glmath::vec2f direction(std::cos(angle), std::sin(angle));
+        const float length = tick % 3 == 0 ? 16.0f : 8.0f;
+        _sdf_primitives_->add_capsule(centre + direction * (radius - length), centre + direction * (radius - 4.0f),
+                                      1.5f, gldraw::COL_WHITE);
+    }
+    // the heading bug turns once every 600 sim frames to show the overlay is live
+    const float heading = static_cast<float>(cycle % 600) / 600.0f * 2.0f * pi;
+    _sdf_primitives_->add_arc(centre, radius + 8.0f, 4.0f, heading - pi / 8.0f, heading + pi / 8.0f, gldraw::COL_GREEN);
+    _sdf_primitives_->add_circle(centre, 4.0f, gldraw::COL_YELLOW);
+    _sdf_primitives_->gen_buffers();
+    _sdf_primitives_->draw();
+
+    glBindVertexArray(0);
+    _render_state_.end_pass();
+}
 #endif
 
-    if (_vmgr_) {
-        if (!_vmgr_->test_buffers()){
-            XPLMDebugString("Buffers corrupted after render\n");
+void do_render(const gldraw::rect &rct, display_target &display) {
+    if (!shaders_ready()) {
+        return;
+    }
+
+    int cycle = XPLMGetCycleNumber();
+    if (cycle != _render_cycle_) {
+        _render_cycle_ = cycle;
+#if defined PER_FRAME_GEOM
+        // the first render of a sim frame releases everything staged in the previous one
+        _frame_arena_.reset();
+#endif
+#if defined USE_ASYNC_TEXTURES
+        if (_texture_loader_) {
+            _texture_loader_->pump(TEXTURE_UPLOAD_BUDGET_MS);
         }
+#endif
     }
+
+#if defined USE_OFFSCREEN_CACHE
+    if (_offscreen_cache_ && _composite_vmgr_ && rct.size.x >= 1.0f && rct.size.y >= 1.0f) {
+        // the first display showing this scene at this size in the sim frame renders it
+        uint64_t content = gldraw::hash_bytes(display.scene, std::strlen(display.scene));
+        const int width = static_cast<int>(rct.size.x), height = static_cast<int>(rct.size.y);
+
+        GLuint texture = 0;
+#if defined USE_REFRESH_SCHEDULER
+        // the render is shared by every display showing this content at this size, between its
+        // refreshes they show what was last rendered
+        const uint64_t refresh_key = gldraw::hash_bytes(&height, sizeof(height), gldraw::hash_bytes(&width, sizeof(width), content));
+        if (_refresh_scheduler_ && !_refresh_scheduler_->is_due(refresh_key, display.refresh_hz, cycle)) {
+            texture = _offscreen_cache_->find(content, width, height, cycle);
+        }
+#endif
+        if (texture == 0) {
+            texture = _offscreen_cache_->render(content, width, height, cycle, [&] {
+#if defined USE_REFRESH_SCHEDULER
+                if (_refresh_scheduler_) {
+                    _refresh_scheduler_->begin_render(refresh_key);
+                    render_scene({{0.0f, 0.0f}, rct.size}, display);
+                    _refresh_scheduler_->end_render();
+                    return;
+                }
+#endif
+                render_scene({{0.0f, 0.0f}, rct.size}, display);
+            });
+        }
+        // no texture when the driver cannot render offscreen at this size, draw straight to the display
+        if (texture != 0) {
+            composite_texture(texture, rct);
+#if defined USE_TEXT_LABELS
+            draw_label(rct, display);
+#endif
+#if defined USE_SDF_PRIMITIVES
+            draw_compass(rct, cycle);
+#endif
+            return;
+        }
+    }
+#endif
+
+    render_scene(rct, display);
+#if defined USE_TEXT_LABELS
+    draw_label(rct, display);
+#endif
+#if defined USE_SDF_PRIMITIVES
+    draw_compass(rct, cycle);
+#endif
 }
 
 static int avionics_draw_callback(XPLMDeviceID inDeviceID, int inIsBefore, void *inRefcon) {
     // only draw in the after
     if (!inIsBefore) {
         do_render({{0.0f,    0.0f},
-                   {1024.0f, 768.0f}});
+                   {1024.0f, 768.0f}}, *static_cast<display_target *>(inRefcon));
     }
     return 1;
 }
@@ -202,7 +617,8 @@ void window_draw_handler(XPLMWindowID id, void *inRefcon) {
     XPLMGetWindowGeometry(id, &left, &top, &right, &bottom);
 
     do_render({{static_cast<float>(left),         static_cast<float>(bottom)},
-               {static_cast<float>(right - left), static_cast<float>(top - bottom)}});
+               {static_cast<float>(right - left), static_cast<float>(top - bottom)}},
+              *static_cast<display_target *>(inRefcon));
 }
 
 void create_window() {
@@ -220,7 +636,7 @@ void create_window() {
     window_params.handleKeyFunc = nullptr;
     window_params.handleCursorFunc = nullptr;
     window_params.handleMouseWheelFunc = nullptr;
-    window_params.refcon = nullptr;
+    window_params.refcon = &_window_display_;
     window_params.decorateAsFloatingWindow = xplm_WindowDecorationRoundRectangle;
     window_params.layer = xplm_WindowLayerFloatingWindows;
 
@@ -252,19 +668,114 @@ PLUGIN_API int XPluginStart(char *name, char *sig, char *desc) {
 #endif
 
     try {
+        _workers_ = std::make_unique<gldraw::worker_pool>(4);
+
+#if defined USE_ASYNC_TEXTURES
+        _texture_loader_ = std::make_unique<gldraw::TextureLoader>(*_workers_);
+        _grid_texture_ = _texture_loader_->load(resolve_resource("uvgrid.jpg"));
+#else
         _grid_texture_id_ = gldraw::create_clamped_texture_from_image_file(resolve_resource("uvgrid.jpg"));
+#endif
+
+#if defined USE_BINDLESS_TEXTURES
+        if (gldraw::BindlessTextures::is_supported()) {
+            _bindless_textures_ = std::make_unique<gldraw::BindlessTextures>();
+        } else {
+            XPLMDebugString("GL_ARB_bindless_texture not supported, binding textures\n");
+        }
+#endif
+
+        // validate every render in debug builds, sample in release to keep catching zink corruption cheaply
+        _buffer_validator_ = std::make_unique<gldraw::BufferValidator>(
+#if !defined (NDEBUG)
+                1
+#endif
+        );
 
         _vmgr_ = std::make_unique<gldraw::VertexManager<gldraw::coloured_vertex>>(
+#if defined(USE_PERSISTENT_RING_BUFFERS)
+                // three avionics devices and the test window clear the manager every frame, keep
+                // enough regions for a few frames in flight
+                gldraw::buffer_usage::persistent_ring, 64, 12
+#elif defined(PER_FRAME_GEOM) && defined(USE_RETAINED_QUADS)
+                // retained geometry outlives the frame arena
+#if defined(USE_STATIC_BUFFERS_ONLY)
+                gldraw::buffer_usage::static_draw
+#else
+                gldraw::buffer_usage::stream
+#endif
+#elif defined(PER_FRAME_GEOM)
+                // rebuilt every frame, stage it in the frame arena
 #if defined(USE_STATIC_BUFFERS_ONLY)
+                gldraw::buffer_usage::static_draw, _frame_arena_
+#else
+                gldraw::buffer_usage::stream, _frame_arena_
+#endif
+#elif defined(USE_STATIC_BUFFERS_ONLY)
                 true
 #endif
         );
 
         if (_vmgr_) {
             // rectangle 1024x768 and uv 0,0 to 1,1
-            _vmgr_->add_quad({{0.0f,    0.0f},
-                              {1024.0f, 768.0f}});
+            _test_quad_ = _vmgr_->add_quad({{0.0f,    0.0f},
+                                            {1024.0f, 768.0f}});
+        }
+
+#if defined USE_GEOMETRY_PIPELINE
+        for (display_target *display: {&_pfd1_display_, &_pfd2_display_, &_mfd_display_, &_window_display_}) {
+            // not staged in the frame arena, it is not safe to allocate from on the workers
+            display->pipeline = std::make_unique<gldraw::GeometryPipeline<gldraw::coloured_vertex>>(
+                    *_workers_,
+#if defined(USE_STATIC_BUFFERS_ONLY)
+                    gldraw::buffer_usage::static_draw
+#else
+                    gldraw::buffer_usage::stream
+#endif
+            );
+        }
+#endif
+
+#if defined USE_OFFSCREEN_CACHE
+        _offscreen_cache_ = std::make_unique<gldraw::OffscreenCache>();
+        _composite_vmgr_ = std::make_unique<gldraw::VertexManager<gldraw::coloured_vertex>>(gldraw::buffer_usage::stream);
+        _composite_vmgr_->set_shader_variant(gldraw::shader_variant::textured);
+        // moved onto each display as it is composited
+        _composite_quad_ = _composite_vmgr_->add_quad({{0.0f,    0.0f},
+                                                       {1024.0f, 768.0f}});
+#endif
+
+#if defined USE_REFRESH_SCHEDULER
+        _refresh_scheduler_ = std::make_unique<gldraw::RefreshScheduler>(RENDER_BUDGET_MS);
+#endif
+
+#if defined USE_INSTANCED_QUADS
+        _iqmgr_ = std::make_unique<gldraw::InstancedQuadManager>();
+        // the same rectangle and uvs as the vertex manager
+        _iqmgr_->add_quad({{0.0f,    0.0f},
+                           {1024.0f, 768.0f}});
+#endif
+
+#if defined USE_TEXT_LABELS
+        try {
+            // shipped in Resources/fonts
+            _label_font_ = std::make_unique<gldraw::SdfFont>(resolve_resource("DejaVuSans.ttf"));
+            _text_layouts_ = std::make_unique<gldraw::TextLayoutCache>();
+            _text_vmgr_ = std::make_unique<gldraw::VertexManager<gldraw::coloured_vertex>>(gldraw::buffer_usage::stream);
+            _text_vmgr_->set_shader_variant(gldraw::shader_variant::sdf);
+        } catch (const std::exception &ex) {
+            // the displays still draw, just without labels
+            XPLMDebugString(std::format("text labels disabled: {}\n", ex.what()).c_str());
         }
+#endif
+
+#if defined USE_SDF_PRIMITIVES
+        _sdf_primitives_ = std::make_unique<gldraw::SdfPrimitiveManager>();
+#endif
+
+        // start every compile now, programs linked by an earlier run load from their binaries
+        gldraw::set_program_binary_cache(get_xp_system_folder() / "Output" / "caches" / "minimal_plugin_shaders");
+        get_scene_shaders();
     } catch (const std::exception &ex) {
         XPLMDebugString(std::format("exception configuring plugin: {}\n", ex.what()).c_str());
     }
@@ -276,6 +787,61 @@ PLUGIN_API int XPluginStart(char *name, char *sig, char *desc) {
 
 PLUGIN_API void XPluginStop(void) {
     XPLMDebugString("XPluginStop\n");
+
+#if defined USE_GEOMETRY_PIPELINE
+    // wait for the builds in flight before the workers and the plugin go away
+    for (display_target *display: {&_pfd1_display_, &_pfd2_display_, &_mfd_display_, &_window_display_}) {
+        display->pipeline.reset();
+    }
+#endif
+#if defined USE_ASYNC_TEXTURES
+    _texture_loader_.reset();
+#endif
+#if defined USE_BINDLESS_TEXTURES
+    // the handles must not outlive the context's textures
+    _bindless_textures_.reset();
+#endif
+    // finishes any decode still queued
+    _workers_.reset();
+
+    gldraw::program_cache_statistics program_stats = gldraw::get_program_cache_statistics();
+    XPLMDebugString(std::format("shader programs: {} loaded from binaries, {} compiled, {} binaries rejected\n",
+                                program_stats.hits, program_stats.compiles, program_stats.rejected).c_str());
+
+#if defined USE_REFRESH_SCHEDULER
+    gldraw::RefreshScheduler::statistics refresh_stats = _refresh_scheduler_ ? _refresh_scheduler_->get_statistics()
+                                                                            : gldraw::RefreshScheduler::statistics{};
+    XPLMDebugString(std::format("display refresh: cpu {:.3f} ms gpu {:.3f} ms per frame, rates scaled by {:.2f}\n",
+                                refresh_stats.cpu_ms, refresh_stats.gpu_ms, refresh_stats.rate_scale).c_str());
+    _refresh_scheduler_.reset();
+#endif
+
+#if defined USE_OFFSCREEN_CACHE
+    _composite_vmgr_.reset();
+    _offscreen_cache_.reset();
+#endif
+
+#if defined USE_TEXT_LABELS
+    gldraw::TextLayoutCache::statistics text_stats = _text_layouts_ ? _text_layouts_->get_statistics()
+                                                                    : gldraw::TextLayoutCache::statistics{};
+    XPLMDebugString(std::format("text layouts: {} hits, {} laid out, {} cached\n",
+                                text_stats.hits, text_stats.misses, text_stats.entries).c_str());
+    _text_vmgr_.reset();
+    _text_layouts_.reset();
+    _label_font_.reset();
+#endif
+
+#if defined USE_SDF_PRIMITIVES
+    _sdf_primitives_.reset();
+#endif
+
+#if defined PER_FRAME_GEOM
+    // report the arena usage so its initial size can be tuned
+    gldraw::frame_arena::statistics arena_stats = _frame_arena_.get_statistics();
+    XPLMDebugString(std::format("frame arena: high water {} bytes, capacity {} bytes in {} blocks, {} overflows\n",
+                                arena_stats.high_water, arena_stats.capacity, arena_stats.block_count,
+                                arena_stats.overflow_count).c_str());
+#endif
 }
 
 PLUGIN_API int XPluginEnable(void) {
@@ -286,6 +852,7 @@ PLUGIN_API int XPluginEnable(void) {
     params.deviceId = xplm_device_G1000_PFD_1;
     params.drawCallbackBefore = nullptr;
     params.drawCallbackAfter = avionics_draw_callback;
+    params.refcon = &_pfd1_display_;
 
     __avionics_callback_id_pfd1 = XPLMRegisterAvionicsCallbacksEx(&params);
     if (__avionics_callback_id_pfd1 == nullptr) {
@@ -295,6 +862,7 @@ PLUGIN_API int XPluginEnable(void) {
     }
 
     params.deviceId = xplm_device_G1000_PFD_2;
+    params.refcon = &_pfd2_display_;
     __avionics_callback_id_pfd2 = XPLMRegisterAvionicsCallbacksEx(&params);
     if (__avionics_callback_id_pfd2 == nullptr) {
         XPLMDebugString("PFD2: XPLMRegisterAvionicsCallbacksEx failed!\n");
@@ -303,6 +871,7 @@ PLUGIN_API int XPluginEnable(void) {
     }
 
     params.deviceId = xplm_device_G1000_MFD;
+    params.refcon = &_mfd_display_;
     __avionics_callback_id_mfd = XPLMRegisterAvionicsCallbacksEx(&params);
     if (__avionics_callback_id_mfd == nullptr) {
         XPLMDebugString("MFD: XPLMRegisterAvionicsCallbacksEx failed!\n");
@@ -0,0 +1,6 @@
+//
+// Created by icarr on 17/10/2026.
+//
+
+#define STB_TRUETYPE_IMPLEMENTATION
+#include <stb/stb_truetype.h>
\ No newline at end of file
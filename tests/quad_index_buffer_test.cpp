@@ -0,0 +1,169 @@
+//
+// Created by icarr on 17/10/2026.
+//
+// Headless check that VertexManagers sharing the quad_index_buffer follow it when it grows. No GL context
+// is needed, the GL calls the managers make are pointed at fakes which, like drivers, hand a deleted
+// buffer name straight out again and keep an object alive while a VAO references it.
+//
+
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <vector>
+
+#define GLAD_GL_IMPLEMENTATION
+#include <glad/gl.h>
+#undef GLAD_GL_IMPLEMENTATION
+
+#include <gldraw/VertexManager.h>
+#include <gldraw/shaders/coloured_vertex.h>
+
+namespace {
+    struct buffer_object {
+        size_t bytes{};
+    };
+
+    struct vertex_array_object {
+        std::shared_ptr<buffer_object> element_buffer;
+    };
+
+    // names to objects, a deleted name is free for reuse while a VAO may still hold its object
+    std::map<GLuint, std::shared_ptr<buffer_object>> __buffers;
+    std::map<GLuint, vertex_array_object> __vertex_arrays;
+    std::map<GLenum, GLuint> __buffer_bindings;
+    GLuint __bound_vertex_array{};
+    int __overruns{};
+
+    GLuint lowest_free_buffer_name() {
+        GLuint name = 1;
+        while (__buffers.contains(name)) {
+            ++name;
+        }
+        return name;
+    }
+
+    void APIENTRY fake_gen_buffers(GLsizei n, GLuint *buffers) {
+        for (GLsizei indx = 0; indx < n; ++indx) {
+            buffers[indx] = lowest_free_buffer_name();
+            __buffers[buffers[indx]] = std::make_shared<buffer_object>();
+        }
+    }
+
+    void APIENTRY fake_delete_buffers(GLsizei n, const GLuint *buffers) {
+        for (GLsizei indx = 0; indx < n; ++indx) {
+            __buffers.erase(buffers[indx]);
+        }
+    }
+
+    void APIENTRY fake_create_vertex_arrays(GLsizei n, GLuint *arrays) {
+        for (GLsizei indx = 0; indx < n; ++indx) {
+            arrays[indx] = static_cast<GLuint>(__vertex_arrays.size() + 1);
+            __vertex_arrays[arrays[indx]] = {};
+        }
+    }
+
+    void APIENTRY fake_delete_vertex_arrays(GLsizei n, const GLuint *arrays) {
+        for (GLsizei indx = 0; indx < n; ++indx) {
+            __vertex_arrays.erase(arrays[indx]);
+        }
+    }
+
+    void APIENTRY fake_bind_vertex_array(GLuint array) {
+        __bound_vertex_array = array;
+    }
+
+    void APIENTRY fake_bind_buffer(GLenum target, GLuint buffer) {
+        __buffer_bindings[target] = buffer;
+        if (target == GL_ELEMENT_ARRAY_BUFFER && __bound_vertex_array != 0) {
+            __vertex_arrays[__bound_vertex_array].element_buffer = buffer != 0 ? __buffers.at(buffer) : nullptr;
+        }
+    }
+
+    std::shared_ptr<buffer_object> bound_buffer(GLenum target) {
+        if (target == GL_ELEMENT_ARRAY_BUFFER) {
+            return __vertex_arrays[__bound_vertex_array].element_buffer;
+        }
+        return __buffers.at(__buffer_bindings[target]);
+    }
+
+    void APIENTRY fake_buffer_data(GLenum target, GLsizeiptr size, const void *, GLenum) {
+        bound_buffer(target)->bytes = size;
+    }
+
+    void APIENTRY fake_buffer_storage(GLenum target, GLsizeiptr size, const void *, GLbitfield) {
+        bound_buffer(target)->bytes = size;
+    }
+
+    void APIENTRY fake_buffer_sub_data(GLenum, GLintptr, GLsizeiptr, const void *) {}
+
+    void APIENTRY fake_draw_elements(GLenum, GLsizei count, GLenum type, const void *indices) {
+        const size_t index_size = type == GL_UNSIGNED_SHORT ? 2 : 4;
+        const std::shared_ptr<buffer_object> &elements = __vertex_arrays[__bound_vertex_array].element_buffer;
+        if (!elements || reinterpret_cast<size_t>(indices) + count * index_size > elements->bytes) {
+            ++__overruns;
+        }
+    }
+
+    // vertex formats and vertex buffer attachment, nothing to check
+    void APIENTRY fake_enable_vertex_array_attrib(GLuint, GLuint) {}
+    void APIENTRY fake_vertex_array_attrib_format(GLuint, GLuint, GLint, GLenum, GLboolean, GLuint) {}
+    void APIENTRY fake_vertex_array_attrib_binding(GLuint, GLuint, GLuint) {}
+    void APIENTRY fake_vertex_array_vertex_buffer(GLuint, GLuint, GLuint, GLintptr, GLsizei) {}
+
+    void install_fake_gl() {
+        glad_glGenBuffers = fake_gen_buffers;
+        glad_glCreateBuffers = fake_gen_buffers;
+        glad_glDeleteBuffers = fake_delete_buffers;
+        glad_glCreateVertexArrays = fake_create_vertex_arrays;
+        glad_glDeleteVertexArrays = fake_delete_vertex_arrays;
+        glad_glBindVertexArray = fake_bind_vertex_array;
+        glad_glBindBuffer = fake_bind_buffer;
+        glad_glBufferData = fake_buffer_data;
+        glad_glBufferStorage = fake_buffer_storage;
+        glad_glBufferSubData = fake_buffer_sub_data;
+        glad_glDrawElements = fake_draw_elements;
+        glad_glEnableVertexArrayAttrib = fake_enable_vertex_array_attrib;
+        glad_glVertexArrayAttribFormat = fake_vertex_array_attrib_format;
+        glad_glVertexArrayAttribBinding = fake_vertex_array_attrib_binding;
+        glad_glVertexArrayVertexBuffer = fake_vertex_array_vertex_buffer;
+        // call the fakes directly rather than through glad's error checking wrappers
+        gladUninstallGLDebug();
+    }
+
+    void add_quads(gldraw::VertexManager<gldraw::coloured_vertex> &manager, size_t quad_count) {
+        manager.clear();
+        std::vector<gldraw::rect> rects(quad_count, gldraw::rect{{0.0f, 0.0f}, {1.0f, 1.0f}});
+        manager.add_quads(rects);
+        manager.gen_buffers();
+    }
+}
+
+int main() {
+    install_fake_gl();
+
+    {
+        gldraw::VertexManager<gldraw::coloured_vertex> first(gldraw::buffer_usage::stream);
+        gldraw::VertexManager<gldraw::coloured_vertex> second(gldraw::buffer_usage::stream);
+
+        // first binds the shared buffer at its initial capacity
+        add_quads(first, 1);
+        first.draw();
+
+        // second outgrows it, the replacement is likely to get the deleted name back
+        const size_t grown_quads = 1000;
+        add_quads(second, grown_quads);
+        second.draw();
+
+        // first now needs the grown buffer too, its VAO must not still hold the old one
+        add_quads(first, grown_quads);
+        first.draw();
+        second.draw();
+    }
+
+    if (__overruns != 0) {
+        std::fprintf(stderr, "FAILED: %d draws read past the end of their element buffer\n", __overruns);
+        return 1;
+    }
+    std::printf("passed\n");
+    return 0;
+}